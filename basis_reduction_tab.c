@@ -38,6 +38,7 @@ struct tab_lp {
 #define GBR_clear(v)		    	    mpq_clear(v)
 #define GBR_set(a,b)			    mpq_set(a,b)
 #define GBR_set_ui(a,b)			    mpq_set_ui(a,b,1)
+#define GBR_add(a,b,c)			    mpq_add(a,b,c)
 #define GBR_mul(a,b,c)			    mpq_mul(a,b,c)
 #define GBR_lt(a,b)			    (mpq_cmp(a,b) < 0)
 #define GBR_is_zero(a)			    (mpq_sgn(a) == 0)
@@ -57,6 +58,7 @@ struct tab_lp {
 #define GBR_clear(v)		    	    mp_rat_free(v)
 #define GBR_set(a,b)			    mp_rat_copy(b,a)
 #define GBR_set_ui(a,b)			    mp_rat_set_uvalue(a,b,1)
+#define GBR_add(a,b,c)			    mp_rat_add(b,c,a)
 #define GBR_mul(a,b,c)			    mp_rat_mul(b,c,a)
 #define GBR_lt(a,b)			    (mp_rat_compare(a,b) < 0)
 #define GBR_is_zero(a)			    (mp_rat_compare_zero(a) == 0)
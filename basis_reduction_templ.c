@@ -25,6 +25,19 @@ static void save_alpha(GBR_LP *lp, int first, int n, GBR_type *alpha)
 		GBR_lp_get_alpha(lp, first + i, &alpha[i]);
 }
 
+/* Is 4 * F_new < 3 * F_old, i.e., would a basis vector with width F_new
+ * be exchanged with a basis vector with width F_old?
+ * "t" is used as temporary storage for two values.
+ */
+static int may_exchange(GBR_type F_new, GBR_type F_old, GBR_type *t)
+{
+	GBR_set_ui(t[0], 4);
+	GBR_mul(t[0], t[0], F_new);
+	GBR_set_ui(t[1], 3);
+	GBR_mul(t[1], t[1], F_old);
+	return GBR_lt(t[0], t[1]);
+}
+
 /* Compute a reduced basis for the set represented by the tableau "tab".
  * tab->basis, which must be initialized by the calling function to an affine
  * unimodular basis, is updated to reflect the reduced basis.
@@ -42,6 +55,15 @@ static void save_alpha(GBR_LP *lp, int first, int n, GBR_type *alpha)
  *  for Integer Programming" of Cook el al. to compute a reduced basis.
  * We use \epsilon = 1/4.
  *
+ * Cook et al. pick the integer mu that minimizes F_i(b_{i+1} + mu b_i),
+ * which requires solving an LP for both floor(alpha) and ceil(alpha).
+ * Since F_i is convex and attains its minimum F_{i+1}(b_{i+1}) at alpha,
+ * no choice of mu can result in an exchange of b_i and b_{i+1}
+ * if 4 F_{i+1}(b_{i+1}) >= 3 F_i(b_i).  In this case, mu is simply
+ * set to the integer closest to alpha without solving these LPs.
+ * The resulting basis is still unimodular, but it may not be fully
+ * reduced in the sense of Cook et al.
+ *
  * If ctx->opt->gbr_only_first is set, the user is only interested
  * in the first direction.  In this case we stop the basis reduction when
  * the width in the first direction becomes smaller than 2.
@@ -185,7 +207,13 @@ struct isl_tab *isl_tab_compute_reduced_basis(struct isl_tab *tab)
 
 		if (isl_int_eq(mu[0], mu[1]))
 			isl_int_set(tmp, mu[0]);
-		else {
+		else if (!may_exchange(F_new, F[i], mu_F)) {
+			/* tmp = floor(alpha + 1/2) */
+			GBR_mul(mu_F[0], alpha, two);
+			GBR_add(mu_F[0], mu_F[0], one);
+			GBR_floor(tmp, mu_F[0]);
+			isl_int_fdiv_q_ui(tmp, tmp, 2);
+		} else {
 			int j;
 
 			for (j = 0; j <= 1; ++j) {
@@ -229,12 +257,7 @@ struct isl_tab *isl_tab_compute_reduced_basis(struct isl_tab *tab)
 		GBR_set(F_old, F[i]);
 
 		use_saved = 0;
-		/* mu_F[0] = 4 * F_new; mu_F[1] = 3 * F_old */
-		GBR_set_ui(mu_F[0], 4);
-		GBR_mul(mu_F[0], mu_F[0], F_new);
-		GBR_set_ui(mu_F[1], 3);
-		GBR_mul(mu_F[1], mu_F[1], F_old);
-		if (GBR_lt(mu_F[0], mu_F[1])) {
+		if (may_exchange(F_new, F_old, mu_F)) {
 			B = isl_mat_swap_rows(B, 1 + i, 1 + i + 1);
 			if (i > tab->n_zero) {
 				use_saved = 1;
@@ -5,6 +5,7 @@
 #include <isl/set.h>
 #include <isl/ast.h>
 #include <isl/schedule.h>
+#include <isl/polynomial_type.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -43,6 +44,9 @@ int isl_options_get_ast_build_allow_else(isl_ctx *ctx);
 isl_stat isl_options_set_ast_build_allow_or(isl_ctx *ctx, int val);
 int isl_options_get_ast_build_allow_or(isl_ctx *ctx);
 
+isl_stat isl_options_set_ast_build_cache(isl_ctx *ctx, int val);
+int isl_options_get_ast_build_cache(isl_ctx *ctx);
+
 isl_ctx *isl_ast_build_get_ctx(__isl_keep isl_ast_build *build);
 
 __isl_constructor
@@ -100,6 +104,11 @@ __isl_give isl_ast_expr *isl_ast_build_expr_from_set(
 __isl_overload
 __isl_give isl_ast_expr *isl_ast_build_expr_from_pw_aff(
 	__isl_keep isl_ast_build *build, __isl_take isl_pw_aff *pa);
+__isl_give isl_ast_expr *isl_ast_build_expr_from_pw_qpolynomial(
+	__isl_keep isl_ast_build *build, __isl_take isl_pw_qpolynomial *pwqp);
+__isl_give isl_ast_expr *isl_ast_build_expr_from_pw_qpolynomial_fold(
+	__isl_keep isl_ast_build *build,
+	__isl_take isl_pw_qpolynomial_fold *pwf);
 __isl_overload
 __isl_give isl_ast_expr *isl_ast_build_access_from_pw_multi_aff(
 	__isl_keep isl_ast_build *build, __isl_take isl_pw_multi_aff *pma);
@@ -115,6 +115,9 @@ typedef struct isl_ctx isl_ctx;
 void *isl_malloc_or_die(isl_ctx *ctx, size_t size);
 void *isl_calloc_or_die(isl_ctx *ctx, size_t nmemb, size_t size);
 void *isl_realloc_or_die(isl_ctx *ctx, void *ptr, size_t size);
+void *isl_malloc_array_or_die(isl_ctx *ctx, size_t nmemb, size_t size);
+void *isl_realloc_array_or_die(isl_ctx *ctx, void *ptr, size_t nmemb,
+	size_t size);
 
 #define isl_alloc(ctx,type,size)	((type *)isl_malloc_or_die(ctx, size))
 #define isl_calloc(ctx,type,size)	((type *)isl_calloc_or_die(ctx,\
@@ -124,11 +127,12 @@ void *isl_realloc_or_die(isl_ctx *ctx, void *ptr, size_t size);
 #define isl_alloc_type(ctx,type)	isl_alloc(ctx,type,sizeof(type))
 #define isl_calloc_type(ctx,type)	isl_calloc(ctx,type,sizeof(type))
 #define isl_realloc_type(ctx,ptr,type)	isl_realloc(ctx,ptr,type,sizeof(type))
-#define isl_alloc_array(ctx,type,n)	isl_alloc(ctx,type,(n)*sizeof(type))
+#define isl_alloc_array(ctx,type,n)	((type *)isl_malloc_array_or_die(ctx,\
+							    n, sizeof(type)))
 #define isl_calloc_array(ctx,type,n)	((type *)isl_calloc_or_die(ctx,\
 							    n, sizeof(type)))
 #define isl_realloc_array(ctx,ptr,type,n) \
-				    isl_realloc(ctx,ptr,type,(n)*sizeof(type))
+		((type *)isl_realloc_array_or_die(ctx, ptr, n, sizeof(type)))
 
 #define isl_die(ctx,errno,msg,code)					\
 	do {								\
@@ -171,6 +175,14 @@ void isl_ctx_set_max_operations(isl_ctx *ctx, unsigned long max_operations);
 unsigned long isl_ctx_get_max_operations(isl_ctx *ctx);
 void isl_ctx_reset_operations(isl_ctx *ctx);
 
+void isl_ctx_set_max_memory(isl_ctx *ctx, unsigned long max_memory);
+unsigned long isl_ctx_get_max_memory(isl_ctx *ctx);
+unsigned long isl_ctx_get_memory(isl_ctx *ctx);
+unsigned long isl_ctx_get_peak_memory(isl_ctx *ctx);
+void isl_ctx_reset_peak_memory(isl_ctx *ctx);
+
+void isl_ctx_clear_closure_cache(isl_ctx *ctx);
+
 #define ISL_ARG_CTX_DECL(prefix,st,args)				\
 st *isl_ctx_peek_ ## prefix(isl_ctx *ctx);
 
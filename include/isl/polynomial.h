@@ -234,6 +234,8 @@ __isl_give isl_pw_qpolynomial *isl_pw_qpolynomial_fix_val(
 __isl_export
 __isl_give isl_val *isl_pw_qpolynomial_eval(
 	__isl_take isl_pw_qpolynomial *pwqp, __isl_take isl_point *pnt);
+isl_stat isl_pw_qpolynomial_eval_batch_si(__isl_keep isl_pw_qpolynomial *pwqp,
+	int n, const long *points, long *num, long *den);
 
 __isl_give isl_val *isl_pw_qpolynomial_max(__isl_take isl_pw_qpolynomial *pwqp);
 __isl_give isl_val *isl_pw_qpolynomial_min(__isl_take isl_pw_qpolynomial *pwqp);
@@ -254,6 +254,8 @@ __isl_give isl_set *isl_set_detect_equalities(__isl_take isl_set *set);
 __isl_export
 __isl_give isl_basic_set *isl_set_affine_hull(__isl_take isl_set *set);
 __isl_give isl_basic_set *isl_set_convex_hull(__isl_take isl_set *set);
+__isl_give isl_basic_set *isl_basic_set_union_convex_hull(
+	__isl_take isl_basic_set *bset1, __isl_take isl_basic_set *bset2);
 __isl_export
 __isl_give isl_basic_set *isl_set_polyhedral_hull(__isl_take isl_set *set);
 __isl_give isl_basic_set *isl_set_simple_hull(__isl_take isl_set *set);
@@ -450,6 +452,9 @@ __isl_give isl_basic_set_list *isl_set_get_basic_set_list(
 
 isl_stat isl_set_foreach_point(__isl_keep isl_set *set,
 	isl_stat (*fn)(__isl_take isl_point *pnt, void *user), void *user);
+isl_stat isl_set_foreach_point_chunk(__isl_keep isl_set *set,
+	int n_chunk, int chunk,
+	isl_stat (*fn)(__isl_take isl_point *pnt, void *user), void *user);
 __isl_give isl_val *isl_set_count_val(__isl_keep isl_set *set);
 
 __isl_constructor
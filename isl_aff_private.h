@@ -157,6 +157,16 @@ isl_stat isl_pw_aff_check_match_domain_space(__isl_keep isl_pw_aff *pa,
 
 __isl_give isl_basic_set *isl_aff_pos_basic_set(__isl_take isl_aff *aff);
 
+isl_bool isl_pw_aff_plain_is_identical(__isl_keep isl_pw_aff *pa1,
+	__isl_keep isl_pw_aff *pa2);
+isl_bool isl_pw_multi_aff_plain_is_identical(
+	__isl_keep isl_pw_multi_aff *pma1, __isl_keep isl_pw_multi_aff *pma2);
+isl_bool isl_union_pw_aff_plain_is_identical(
+	__isl_keep isl_union_pw_aff *upa1, __isl_keep isl_union_pw_aff *upa2);
+isl_bool isl_union_pw_multi_aff_plain_is_identical(
+	__isl_keep isl_union_pw_multi_aff *upma1,
+	__isl_keep isl_union_pw_multi_aff *upma2);
+
 #undef BASE
 #define BASE pw_aff
 
@@ -982,13 +982,15 @@ __isl_give isl_ast_node *isl_ast_node_dup(__isl_keep isl_ast_node *node)
 			return isl_ast_node_free(dup);
 		break;
 	case isl_ast_node_for:
+		dup->u.f.degenerate = node->u.f.degenerate;
 		dup->u.f.iterator = isl_ast_expr_copy(node->u.f.iterator);
 		dup->u.f.init = isl_ast_expr_copy(node->u.f.init);
 		dup->u.f.cond = isl_ast_expr_copy(node->u.f.cond);
 		dup->u.f.inc = isl_ast_expr_copy(node->u.f.inc);
 		dup->u.f.body = isl_ast_node_copy(node->u.f.body);
-		if (!dup->u.f.iterator || !dup->u.f.init || !dup->u.f.cond ||
-		    !dup->u.f.inc || !dup->u.f.body)
+		if (!dup->u.f.iterator || !dup->u.f.init || !dup->u.f.body ||
+		    (node->u.f.cond && !dup->u.f.cond) ||
+		    (node->u.f.inc && !dup->u.f.inc))
 			return isl_ast_node_free(dup);
 		break;
 	case isl_ast_node_block:
@@ -1025,6 +1027,92 @@ __isl_give isl_ast_node *isl_ast_node_cow(__isl_take isl_ast_node *node)
 	return isl_ast_node_dup(node);
 }
 
+/* Return a copy of the list of nodes "list" that does not share
+ * any nodes with "list".
+ */
+static __isl_give isl_ast_node_list *isl_ast_node_list_dup_tree(
+	__isl_keep isl_ast_node_list *list)
+{
+	int i, n;
+	isl_ast_node_list *dup;
+
+	if (!list)
+		return NULL;
+
+	n = isl_ast_node_list_n_ast_node(list);
+	dup = isl_ast_node_list_alloc(isl_ast_node_list_get_ctx(list), n);
+	for (i = 0; i < n; ++i) {
+		isl_ast_node *node;
+
+		node = isl_ast_node_dup_tree(list->p[i]);
+		dup = isl_ast_node_list_add(dup, node);
+	}
+
+	return dup;
+}
+
+/* Return a copy of "node" that does not share any (descendant) nodes
+ * with "node".
+ *
+ * Parts of the AST generator modify the descendants of a node in place,
+ * so a node that may also be used elsewhere needs to be copied completely
+ * before it can be handed to the AST generator.
+ * The expressions are not modified in place and can therefore be shared.
+ */
+__isl_give isl_ast_node *isl_ast_node_dup_tree(__isl_keep isl_ast_node *node)
+{
+	isl_ast_node *dup;
+
+	dup = isl_ast_node_dup(node);
+	if (!dup)
+		return NULL;
+
+	switch (dup->type) {
+	case isl_ast_node_if:
+		isl_ast_node_free(dup->u.i.then);
+		dup->u.i.then = isl_ast_node_dup_tree(node->u.i.then);
+		if (!dup->u.i.then)
+			return isl_ast_node_free(dup);
+		if (!node->u.i.else_node)
+			break;
+		isl_ast_node_free(dup->u.i.else_node);
+		dup->u.i.else_node = isl_ast_node_dup_tree(node->u.i.else_node);
+		if (!dup->u.i.else_node)
+			return isl_ast_node_free(dup);
+		break;
+	case isl_ast_node_for:
+		isl_ast_node_free(dup->u.f.body);
+		dup->u.f.body = isl_ast_node_dup_tree(node->u.f.body);
+		if (!dup->u.f.body)
+			return isl_ast_node_free(dup);
+		break;
+	case isl_ast_node_block:
+		isl_ast_node_list_free(dup->u.b.children);
+		dup->u.b.children =
+			isl_ast_node_list_dup_tree(node->u.b.children);
+		if (!dup->u.b.children)
+			return isl_ast_node_free(dup);
+		break;
+	case isl_ast_node_mark:
+		isl_ast_node_free(dup->u.m.node);
+		dup->u.m.node = isl_ast_node_dup_tree(node->u.m.node);
+		if (!dup->u.m.node)
+			return isl_ast_node_free(dup);
+		break;
+	case isl_ast_node_user:
+	case isl_ast_node_error:
+		break;
+	}
+
+	if (node->annotation) {
+		dup->annotation = isl_id_copy(node->annotation);
+		if (!dup->annotation)
+			return isl_ast_node_free(dup);
+	}
+
+	return dup;
+}
+
 __isl_null isl_ast_node *isl_ast_node_free(__isl_take isl_ast_node *node)
 {
 	if (!node)
@@ -10,6 +10,9 @@
  * B.P. 105 - 78153 Le Chesnay, France
  */
 
+#include <isl_map_private.h>
+#include <isl_union_map_private.h>
+#include <isl_aff_private.h>
 #include <isl/val.h>
 #include <isl/space.h>
 #include <isl/map.h>
@@ -20,6 +23,8 @@
 #include <isl/union_map.h>
 #include <isl_ast_build_private.h>
 #include <isl_ast_private.h>
+#include <isl_schedule_node_private.h>
+#include <isl_schedule_tree.h>
 #include <isl_config.h>
 
 /* Construct a map that isolates the current dimension.
@@ -105,6 +110,136 @@ static __isl_give isl_id *generate_name(isl_ctx *ctx, int i,
 	return isl_id_alloc(ctx, name, NULL);
 }
 
+/* The maximal number of entries in an isl_ast_build_cache.
+ */
+#define ISL_AST_BUILD_CACHE_SIZE	256
+
+/* The maximal total number of AST nodes in the entries
+ * of an isl_ast_build_cache.
+ */
+#define ISL_AST_BUILD_CACHE_MAX_NODES	(1 << 16)
+
+/* The number of AST generation options that are taken into account
+ * by an isl_ast_build_cache.  See get_options.
+ */
+#define ISL_AST_BUILD_CACHE_N_OPT	9
+
+/* An entry in an isl_ast_build_cache.
+ *
+ * "list" is the list of grafts that was generated for the schedule tree
+ * "tree" with inverse schedule "executed", in the context of "build".
+ * "build" is a copy of the isl_ast_build that does not refer
+ * to the cache itself.
+ * "opt" contains the values of the AST generation options
+ * at the time "list" was generated.
+ * "hash" is the hash value of the key formed by the fields above,
+ * computed by cache_hash.
+ * "size" is the number of AST nodes in "list".
+ *
+ * "prev" and "next" link the entry to the entries that were
+ * used less and more recently.
+ */
+struct isl_ast_build_cache_entry {
+	uint32_t hash;
+	isl_schedule_tree *tree;
+	isl_union_map *executed;
+	isl_ast_build *build;
+	int opt[ISL_AST_BUILD_CACHE_N_OPT];
+
+	isl_ast_graft_list *list;
+	int size;
+
+	struct isl_ast_build_cache_entry *prev;
+	struct isl_ast_build_cache_entry *next;
+};
+
+/* A cache of ASTs generated for schedule subtrees, shared by
+ * an isl_ast_build and all isl_ast_builds derived from it.
+ *
+ * "table" maps the hash value of a key to the entries with that key.
+ * "first" and "last" are the least and the most recently used entries.
+ * "n" is the number of entries and "size" the total number
+ * of AST nodes in these entries.
+ * Once either exceeds its maximum, the least recently used entries
+ * are removed.
+ * "n_hit" is the number of times an AST was found in the cache.
+ */
+struct isl_ast_build_cache {
+	int ref;
+	isl_ctx *ctx;
+
+	struct isl_hash_table table;
+	struct isl_ast_build_cache_entry *first;
+	struct isl_ast_build_cache_entry *last;
+	int n;
+	int size;
+	int n_hit;
+};
+
+static __isl_give struct isl_ast_build_cache *isl_ast_build_cache_alloc(
+	isl_ctx *ctx)
+{
+	struct isl_ast_build_cache *cache;
+
+	cache = isl_calloc_type(ctx, struct isl_ast_build_cache);
+	if (!cache)
+		return NULL;
+
+	cache->ref = 1;
+	cache->ctx = ctx;
+	isl_ctx_ref(ctx);
+	if (isl_hash_table_init(ctx, &cache->table, 0) < 0) {
+		isl_ctx_deref(ctx);
+		free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+static __isl_give struct isl_ast_build_cache *isl_ast_build_cache_copy(
+	__isl_keep struct isl_ast_build_cache *cache)
+{
+	if (!cache)
+		return NULL;
+
+	cache->ref++;
+	return cache;
+}
+
+/* Free all memory associated to "entry".
+ */
+static void cache_entry_free(struct isl_ast_build_cache_entry *entry)
+{
+	isl_schedule_tree_free(entry->tree);
+	isl_union_map_free(entry->executed);
+	isl_ast_build_free(entry->build);
+	isl_ast_graft_list_free(entry->list);
+	free(entry);
+}
+
+static __isl_null struct isl_ast_build_cache *isl_ast_build_cache_free(
+	__isl_take struct isl_ast_build_cache *cache)
+{
+	struct isl_ast_build_cache_entry *entry, *next;
+
+	if (!cache)
+		return NULL;
+
+	if (--cache->ref > 0)
+		return NULL;
+
+	for (entry = cache->first; entry; entry = next) {
+		next = entry->next;
+		cache_entry_free(entry);
+	}
+	isl_hash_table_clear(&cache->table);
+	isl_ctx_deref(cache->ctx);
+	free(cache);
+
+	return NULL;
+}
+
 /* Create an isl_ast_build with "set" as domain.
  *
  * The input set is usually a parameter domain, but we currently allow it to
@@ -148,7 +283,14 @@ __isl_give isl_ast_build *isl_ast_build_from_context(__isl_take isl_set *set)
 	if (isl_space_is_params(space))
 		space = isl_space_set_from_params(space);
 
-	return isl_ast_build_init_derived(build, space);
+	build = isl_ast_build_init_derived(build, space);
+	if (build && isl_options_get_ast_build_cache(ctx)) {
+		build->cache = isl_ast_build_cache_alloc(ctx);
+		if (!build->cache)
+			return isl_ast_build_free(build);
+	}
+
+	return build;
 error:
 	isl_set_free(set);
 	return NULL;
@@ -196,6 +338,7 @@ __isl_give isl_ast_build *isl_ast_build_dup(__isl_keep isl_ast_build *build)
 	dup->domain = isl_set_copy(build->domain);
 	dup->generated = isl_set_copy(build->generated);
 	dup->pending = isl_set_copy(build->pending);
+	dup->domain_hull = isl_basic_set_copy(build->domain_hull);
 	dup->values = isl_multi_aff_copy(build->values);
 	dup->internal2input = isl_multi_aff_copy(build->internal2input);
 	dup->value = isl_pw_aff_copy(build->value);
@@ -217,6 +360,7 @@ __isl_give isl_ast_build *isl_ast_build_dup(__isl_keep isl_ast_build *build)
 	dup->create_leaf = build->create_leaf;
 	dup->create_leaf_user = build->create_leaf_user;
 	dup->node = isl_schedule_node_copy(build->node);
+	dup->cache = isl_ast_build_cache_copy(build->cache);
 	if (build->loop_type) {
 		int i;
 
@@ -241,6 +385,34 @@ __isl_give isl_ast_build *isl_ast_build_dup(__isl_keep isl_ast_build *build)
 	return dup;
 }
 
+/* Clear build->domain_hull.
+ * This function should be called whenever build->domain changes.
+ */
+static void isl_ast_build_reset_domain_hull(__isl_keep isl_ast_build *build)
+{
+	if (!build)
+		return;
+	isl_basic_set_free(build->domain_hull);
+	build->domain_hull = NULL;
+}
+
+/* Return the affine hull of build->domain.
+ *
+ * The affine hull is computed on demand and cached in build->domain_hull.
+ * The cache is cleared through isl_ast_build_reset_domain_hull
+ * whenever build->domain changes.
+ */
+static __isl_give isl_basic_set *isl_ast_build_get_domain_hull(
+	__isl_keep isl_ast_build *build)
+{
+	if (!build)
+		return NULL;
+	if (!build->domain_hull)
+		build->domain_hull =
+			isl_set_affine_hull(isl_set_copy(build->domain));
+	return isl_basic_set_copy(build->domain_hull);
+}
+
 /* Align the parameters of "build" to those of "model", introducing
  * additional parameters if needed.
  */
@@ -253,6 +425,7 @@ __isl_give isl_ast_build *isl_ast_build_align_params(
 
 	build->domain = isl_set_align_params(build->domain,
 						isl_space_copy(model));
+	isl_ast_build_reset_domain_hull(build);
 	build->generated = isl_set_align_params(build->generated,
 						isl_space_copy(model));
 	build->pending = isl_set_align_params(build->pending,
@@ -307,6 +480,7 @@ __isl_null isl_ast_build *isl_ast_build_free(
 	isl_set_free(build->domain);
 	isl_set_free(build->generated);
 	isl_set_free(build->pending);
+	isl_basic_set_free(build->domain_hull);
 	isl_multi_aff_free(build->values);
 	isl_multi_aff_free(build->internal2input);
 	isl_pw_aff_free(build->value);
@@ -318,6 +492,7 @@ __isl_null isl_ast_build *isl_ast_build_free(
 	isl_schedule_node_free(build->node);
 	free(build->loop_type);
 	isl_set_free(build->isolated);
+	isl_ast_build_cache_free(build->cache);
 
 	free(build);
 
@@ -699,6 +874,7 @@ static __isl_give isl_ast_build *isl_ast_build_init(
 	set = isl_set_universe(isl_space_copy(space));
 	build->domain = isl_set_intersect_params(isl_set_copy(set),
 						    build->domain);
+	isl_ast_build_reset_domain_hull(build);
 	build->pending = isl_set_intersect_params(isl_set_copy(set),
 						    build->pending);
 	build->generated = isl_set_intersect_params(set, build->generated);
@@ -844,6 +1020,7 @@ __isl_give isl_ast_build *isl_ast_build_set_loop_bounds(
 	build = update_values(build, isl_basic_set_copy(bounds));
 	if (!build)
 		goto error;
+	isl_ast_build_reset_domain_hull(build);
 	set = isl_set_from_basic_set(isl_basic_set_copy(bounds));
 	if (isl_ast_build_has_affine_value(build, build->depth)) {
 		set = isl_set_eliminate(set, isl_dim_set, build->depth, 1);
@@ -925,6 +1102,7 @@ static __isl_give isl_ast_build *isl_ast_build_restrict_internal(
 	set = isl_set_compute_divs(set);
 	build->domain = isl_set_intersect(build->domain, set);
 	build->domain = isl_set_coalesce(build->domain);
+	isl_ast_build_reset_domain_hull(build);
 
 	if (!build->domain)
 		return isl_ast_build_free(build);
@@ -976,6 +1154,7 @@ __isl_give isl_ast_build *isl_ast_build_replace_pending_by_guard(
 
 	isl_set_free(build->domain);
 	build->domain = isl_set_copy(build->generated);
+	isl_ast_build_reset_domain_hull(build);
 	isl_set_free(build->pending);
 	build->pending = isl_set_universe(isl_set_get_space(build->domain));
 
@@ -1419,6 +1598,7 @@ __isl_give isl_ast_build *isl_ast_build_include_stride(
 	set = isl_ast_build_get_stride_constraint(build);
 
 	build->domain = isl_set_intersect(build->domain, isl_set_copy(set));
+	isl_ast_build_reset_domain_hull(build);
 	build->generated = isl_set_intersect(build->generated, set);
 	if (!build->domain || !build->generated)
 		return isl_ast_build_free(build);
@@ -1767,6 +1947,7 @@ __isl_give isl_ast_build *isl_ast_build_insert_dim(
 	build->iterators = isl_id_list_insert(build->iterators, pos, id);
 	build->domain = isl_set_insert_dims(build->domain,
 						isl_dim_set, pos, 1);
+	isl_ast_build_reset_domain_hull(build);
 	build->generated = isl_set_insert_dims(build->generated,
 						isl_dim_set, pos, 1);
 	build->pending = isl_set_insert_dims(build->pending,
@@ -1970,6 +2151,7 @@ __isl_give isl_ast_build *isl_ast_build_product(
 
 	set = isl_set_universe(isl_space_copy(space));
 	build->domain = isl_set_product(build->domain, isl_set_copy(set));
+	isl_ast_build_reset_domain_hull(build);
 	build->pending = isl_set_product(build->pending, isl_set_copy(set));
 	build->generated = isl_set_product(build->generated, set);
 
@@ -2236,13 +2418,26 @@ error:
  * the iterators of already generated loops.
  *
  * The domain of "aff" is assumed to live in the (internal) schedule domain.
+ *
+ * If "aff" does not involve any integer divisions, then isl_aff_gist
+ * only exploits the equalities in the affine hull of build->domain.
+ * Use the cached affine hull in this case instead of recomputing it
+ * for every call.
  */
 __isl_give isl_aff *isl_ast_build_compute_gist_aff(
 	__isl_keep isl_ast_build *build, __isl_take isl_aff *aff)
 {
+	int n_div;
+
 	if (!build)
 		goto error;
 
+	n_div = isl_aff_dim(aff, isl_dim_div);
+	if (n_div < 0)
+		goto error;
+	if (n_div == 0)
+		return isl_aff_substitute_equalities(aff,
+					isl_ast_build_get_domain_hull(build));
 	aff = isl_aff_gist(aff, isl_set_copy(build->domain));
 
 	return aff;
@@ -2566,3 +2761,451 @@ __isl_give isl_ast_build *isl_ast_build_set_single_valued(
 
 	return build;
 }
+
+/* Should the AST generated for the subtree at "node" be looked up in
+ * and added to the cache of "build"?
+ *
+ * This is only the case if "build" has a cache and if the AST is
+ * completely determined by the subtree and the state of "build".
+ * In particular, no user callbacks can be set since they would
+ * not get called on a cached AST and they may depend on
+ * information that is not taken into account by the cache.
+ * Similarly, "build" should not refer to a band node and
+ * the subtree should not depend on any outer schedule nodes.
+ *
+ * Furthermore, only the ASTs of the subtrees that are most likely
+ * to be shared by different schedule trees are cached, i.e.,
+ * those rooted at the child of the root domain node and those
+ * rooted at filter nodes (the children of sequence and set nodes).
+ * Caching the AST of every node along a chain of nested nodes
+ * would store copies of the same inner ASTs over and over again.
+ */
+isl_bool isl_ast_build_cache_applies(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_node *node)
+{
+	int anchored, depth;
+	enum isl_schedule_node_type type;
+
+	if (!build || !node)
+		return isl_bool_error;
+	if (!build->cache)
+		return isl_bool_false;
+	if (build->at_each_domain || build->before_each_for ||
+	    build->after_each_for || build->before_each_mark ||
+	    build->after_each_mark || build->create_leaf)
+		return isl_bool_false;
+	if (build->node)
+		return isl_bool_false;
+
+	anchored = isl_schedule_node_is_subtree_anchored(node);
+	if (anchored < 0)
+		return isl_bool_error;
+	if (anchored)
+		return isl_bool_false;
+
+	type = isl_schedule_node_get_type(node);
+	if (type < 0)
+		return isl_bool_error;
+	if (type == isl_schedule_node_filter)
+		return isl_bool_true;
+	depth = isl_schedule_node_get_tree_depth(node);
+	if (depth < 0)
+		return isl_bool_error;
+	return depth == 1 ? isl_bool_true : isl_bool_false;
+}
+
+/* Store the values of the AST generation options of "ctx"
+ * that affect the generated AST in "opt".
+ */
+static void get_options(isl_ctx *ctx, int opt[ISL_AST_BUILD_CACHE_N_OPT])
+{
+	opt[0] = isl_options_get_ast_build_atomic_upper_bound(ctx);
+	opt[1] = isl_options_get_ast_build_prefer_pdiv(ctx);
+	opt[2] = isl_options_get_ast_build_detect_min_max(ctx);
+	opt[3] = isl_options_get_ast_build_exploit_nested_bounds(ctx);
+	opt[4] = isl_options_get_ast_build_group_coscheduled(ctx);
+	opt[5] = isl_options_get_ast_build_separation_bounds(ctx);
+	opt[6] = isl_options_get_ast_build_scale_strides(ctx);
+	opt[7] = isl_options_get_ast_build_allow_else(ctx);
+	opt[8] = isl_options_get_ast_build_allow_or(ctx);
+}
+
+/* Are "ma1" and "ma2" obviously equal, where either may be NULL?
+ */
+static isl_bool optional_multi_aff_plain_is_equal(__isl_keep isl_multi_aff *ma1,
+	__isl_keep isl_multi_aff *ma2)
+{
+	if (!ma1 || !ma2)
+		return ma1 == ma2 ? isl_bool_true : isl_bool_false;
+	return isl_multi_aff_plain_is_equal(ma1, ma2);
+}
+
+/* Do "build1" and "build2" represent the same state of the AST generation
+ * (with respect to the information that is used by the AST generator
+ * when "build1" and "build2" do not refer to a band node)?
+ *
+ * The sets and relations are compared using isl_set_plain_is_identical and
+ * isl_union_map_plain_is_identical rather than through plain equality
+ * since the generated AST may depend on their internal representation.
+ * build->value is compared by pointer for the same reason.
+ */
+static isl_bool builds_match(__isl_keep isl_ast_build *build1,
+	__isl_keep isl_ast_build *build2)
+{
+	int i, n;
+	isl_bool equal;
+
+	if (build1->outer_pos != build2->outer_pos ||
+	    build1->depth != build2->depth ||
+	    build1->single_valued != build2->single_valued ||
+	    build1->value != build2->value)
+		return isl_bool_false;
+
+	n = isl_id_list_n_id(build1->iterators);
+	if (n != isl_id_list_n_id(build2->iterators))
+		return isl_bool_false;
+	for (i = 0; i < n; ++i) {
+		isl_id *id1, *id2;
+
+		id1 = isl_id_list_get_id(build1->iterators, i);
+		id2 = isl_id_list_get_id(build2->iterators, i);
+		isl_id_free(id1);
+		isl_id_free(id2);
+		if (id1 != id2)
+			return isl_bool_false;
+	}
+
+	equal = isl_set_plain_is_identical(build1->domain, build2->domain);
+	if (equal >= 0 && equal)
+		equal = isl_set_plain_is_identical(build1->generated,
+						build2->generated);
+	if (equal >= 0 && equal)
+		equal = isl_set_plain_is_identical(build1->pending,
+						build2->pending);
+	if (equal >= 0 && equal)
+		equal = isl_multi_aff_plain_is_equal(build1->values,
+						build2->values);
+	if (equal >= 0 && equal)
+		equal = isl_vec_is_equal(build1->strides, build2->strides);
+	if (equal >= 0 && equal)
+		equal = isl_multi_aff_plain_is_equal(build1->offsets,
+						build2->offsets);
+	if (equal >= 0 && equal)
+		equal = optional_multi_aff_plain_is_equal(build1->internal2input,
+						build2->internal2input);
+	if (equal >= 0 && equal)
+		equal = isl_union_map_plain_is_identical(build1->options,
+						build2->options);
+	if (equal < 0 || !equal)
+		return equal;
+	if (!build1->executed || !build2->executed)
+		return build1->executed == build2->executed ?
+			isl_bool_true : isl_bool_false;
+	return isl_union_map_plain_is_identical(build1->executed,
+						build2->executed);
+}
+
+/* Compute a hash value for the key formed by the schedule tree "tree",
+ * the inverse schedule "executed", the state of "build" and
+ * the values "opt" of the AST generation options.
+ *
+ * Only the root of "tree" is taken into account to avoid
+ * having to traverse the entire subtree.  The representations
+ * of "executed" and of the domain of "build" already distinguish
+ * most subtrees.
+ * Keys that are considered equal by cache_entry_matches
+ * have the same hash value.
+ */
+static uint32_t cache_hash(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_tree *tree, __isl_keep isl_union_map *executed,
+	int opt[ISL_AST_BUILD_CACHE_N_OPT])
+{
+	int i;
+	uint32_t hash, h;
+
+	hash = isl_hash_init();
+	isl_hash_byte(hash, isl_schedule_tree_get_type(tree) & 0xFF);
+	isl_hash_byte(hash, isl_schedule_tree_n_children(tree) & 0xFF);
+	isl_hash_byte(hash, build->depth & 0xFF);
+	for (i = 0; i < ISL_AST_BUILD_CACHE_N_OPT; ++i)
+		isl_hash_byte(hash, opt[i] & 0xFF);
+	h = isl_union_map_plain_get_hash(executed);
+	isl_hash_hash(hash, h);
+	h = isl_set_plain_get_hash(build->domain);
+	isl_hash_hash(hash, h);
+
+	return hash;
+}
+
+/* The key that is looked up in an isl_ast_build_cache
+ * by isl_ast_build_cache_find.
+ * "match" is set by cache_entry_matches to the result of
+ * the last comparison, such that errors can be detected.
+ */
+struct isl_ast_build_cache_key {
+	isl_ast_build *build;
+	isl_schedule_tree *tree;
+	isl_union_map *executed;
+	int opt[ISL_AST_BUILD_CACHE_N_OPT];
+
+	isl_bool match;
+};
+
+/* Does the isl_ast_build_cache_entry "entry" contain the AST generated
+ * for the key "val"?
+ *
+ * All objects are compared through exact comparisons
+ * (isl_schedule_tree_plain_is_identical,
+ * isl_union_map_plain_is_identical and those in builds_match)
+ * since the generated AST may depend on their internal representation.
+ * None of these comparisons modifies the internal representation
+ * of its inputs.
+ */
+static int cache_entry_matches(const void *entry, const void *val)
+{
+	struct isl_ast_build_cache_entry *cache_entry;
+	struct isl_ast_build_cache_key *key;
+	int i;
+	isl_bool equal;
+
+	cache_entry = (struct isl_ast_build_cache_entry *) entry;
+	key = (struct isl_ast_build_cache_key *) val;
+
+	for (i = 0; i < ISL_AST_BUILD_CACHE_N_OPT; ++i)
+		if (cache_entry->opt[i] != key->opt[i])
+			return 0;
+
+	equal = builds_match(cache_entry->build, key->build);
+	if (equal >= 0 && equal)
+		equal = isl_union_map_plain_is_identical(cache_entry->executed,
+							key->executed);
+	if (equal >= 0 && equal)
+		equal = isl_schedule_tree_plain_is_identical(cache_entry->tree,
+							key->tree);
+
+	key->match = equal;
+	return equal < 0 ? 1 : equal;
+}
+
+/* Is "entry" the same as the isl_ast_build_cache_entry "val"?
+ */
+static int cache_entry_is(const void *entry, const void *val)
+{
+	return entry == val;
+}
+
+/* Remove "entry" from the list of entries of "cache",
+ * without removing it from cache->table.
+ */
+static void cache_unlink(struct isl_ast_build_cache *cache,
+	struct isl_ast_build_cache_entry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		cache->first = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		cache->last = entry->prev;
+	entry->prev = entry->next = NULL;
+}
+
+/* Append "entry" to the list of entries of "cache",
+ * marking it as the most recently used entry.
+ */
+static void cache_append(struct isl_ast_build_cache *cache,
+	struct isl_ast_build_cache_entry *entry)
+{
+	entry->prev = cache->last;
+	entry->next = NULL;
+	if (cache->last)
+		cache->last->next = entry;
+	else
+		cache->first = entry;
+	cache->last = entry;
+}
+
+/* Remove "entry" from "cache" and free it.
+ */
+static void cache_remove(struct isl_ast_build_cache *cache,
+	struct isl_ast_build_cache_entry *entry)
+{
+	struct isl_hash_table_entry *hash_entry;
+
+	hash_entry = isl_hash_table_find(cache->ctx, &cache->table,
+					entry->hash, &cache_entry_is, entry, 0);
+	if (hash_entry)
+		isl_hash_table_remove(cache->ctx, &cache->table, hash_entry);
+	cache_unlink(cache, entry);
+	cache->n--;
+	cache->size -= entry->size;
+	cache_entry_free(entry);
+}
+
+/* Return the number of times an AST was found in the cache of "build".
+ */
+int isl_ast_build_cache_get_n_hit(__isl_keep isl_ast_build *build)
+{
+	if (!build || !build->cache)
+		return -1;
+	return build->cache->n_hit;
+}
+
+/* Look for an AST generated for the subtree at "node"
+ * with inverse schedule "executed" in the context of "build"
+ * in the cache of "build".
+ * If one can be found, then return true and store a copy in "list".
+ * The entry is then marked as the most recently used entry.
+ *
+ * The caller is responsible for checking that
+ * isl_ast_build_cache_applies returns true.
+ * The grafts and AST nodes in the cache are not shared with
+ * the returned list since they may get modified by the caller.
+ */
+isl_bool isl_ast_build_cache_find(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_node *node, __isl_keep isl_union_map *executed,
+	__isl_give isl_ast_graft_list **list)
+{
+	uint32_t hash;
+	struct isl_ast_build_cache *cache;
+	struct isl_ast_build_cache_key key;
+	struct isl_ast_build_cache_entry *entry;
+	struct isl_hash_table_entry *hash_entry;
+
+	if (!build || !build->cache || !node || !executed || !list)
+		return isl_bool_error;
+
+	cache = build->cache;
+	key.build = build;
+	key.executed = executed;
+	key.tree = isl_schedule_node_get_tree(node);
+	key.match = isl_bool_false;
+	if (!key.tree)
+		return isl_bool_error;
+	get_options(isl_ast_build_get_ctx(build), key.opt);
+	hash = cache_hash(build, key.tree, executed, key.opt);
+	hash_entry = isl_hash_table_find(cache->ctx, &cache->table, hash,
+					&cache_entry_matches, &key, 0);
+	isl_schedule_tree_free(key.tree);
+	if (key.match < 0)
+		return isl_bool_error;
+	if (!hash_entry)
+		return isl_bool_false;
+
+	entry = hash_entry->data;
+	*list = isl_ast_graft_list_dup_tree(entry->list);
+	if (!*list)
+		return isl_bool_error;
+	cache->n_hit++;
+	cache_unlink(cache, entry);
+	cache_append(cache, entry);
+
+	return isl_bool_true;
+}
+
+/* Increment the number of AST nodes pointed to by "user".
+ */
+static isl_bool count_node(__isl_keep isl_ast_node *node, void *user)
+{
+	int *n = user;
+
+	(*n)++;
+
+	return isl_bool_true;
+}
+
+/* Return the number of AST nodes in "list" or -1 on error.
+ */
+static int graft_list_size(__isl_keep isl_ast_graft_list *list)
+{
+	int i, n, size = 0;
+
+	n = isl_ast_graft_list_n_ast_graft(list);
+	for (i = 0; i < n; ++i) {
+		isl_ast_graft *graft;
+		isl_stat r;
+
+		graft = isl_ast_graft_list_get_ast_graft(list, i);
+		if (!graft)
+			return -1;
+		r = isl_ast_node_foreach_descendant_top_down(graft->node,
+							&count_node, &size);
+		isl_ast_graft_free(graft);
+		if (r < 0)
+			return -1;
+	}
+
+	return size;
+}
+
+/* Add "list", the AST generated for the subtree at "node"
+ * with inverse schedule "executed" in the context of "build",
+ * to the cache of "build".
+ *
+ * The caller is responsible for checking that
+ * isl_ast_build_cache_applies returns true.
+ * The copy of "build" that is stored in the cache
+ * does not refer to the cache itself.
+ *
+ * The least recently used entries are removed until there is room
+ * for the new entry.  An AST that is too large to fit in the cache
+ * on its own is not added.
+ */
+isl_stat isl_ast_build_cache_add(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_node *node, __isl_keep isl_union_map *executed,
+	__isl_keep isl_ast_graft_list *list)
+{
+	struct isl_ast_build_cache *cache;
+	struct isl_ast_build_cache_entry *entry;
+	struct isl_hash_table_entry *hash_entry;
+	isl_ctx *ctx;
+	int size;
+
+	if (!build || !build->cache || !node || !executed || !list)
+		return isl_stat_error;
+
+	size = graft_list_size(list);
+	if (size < 0)
+		return isl_stat_error;
+	if (size > ISL_AST_BUILD_CACHE_MAX_NODES)
+		return isl_stat_ok;
+
+	cache = build->cache;
+	while (cache->first && (cache->n >= ISL_AST_BUILD_CACHE_SIZE ||
+			cache->size + size > ISL_AST_BUILD_CACHE_MAX_NODES))
+		cache_remove(cache, cache->first);
+
+	ctx = isl_ast_build_get_ctx(build);
+	entry = isl_calloc_type(ctx, struct isl_ast_build_cache_entry);
+	if (!entry)
+		return isl_stat_error;
+	entry->build = isl_ast_build_dup(build);
+	if (entry->build)
+		entry->build->cache =
+			isl_ast_build_cache_free(entry->build->cache);
+	entry->tree = isl_schedule_node_get_tree(node);
+	entry->executed = isl_union_map_copy(executed);
+	entry->list = isl_ast_graft_list_dup_tree(list);
+	entry->size = size;
+	get_options(ctx, entry->opt);
+	if (!entry->build || !entry->tree || !entry->executed || !entry->list) {
+		cache_entry_free(entry);
+		return isl_stat_error;
+	}
+	entry->hash = cache_hash(entry->build, entry->tree, entry->executed,
+				entry->opt);
+
+	hash_entry = isl_hash_table_find(ctx, &cache->table, entry->hash,
+					&cache_entry_is, entry, 1);
+	if (!hash_entry) {
+		cache_entry_free(entry);
+		return isl_stat_error;
+	}
+	hash_entry->data = entry;
+	cache_append(cache, entry);
+	cache->n++;
+	cache->size += size;
+
+	return isl_stat_ok;
+}
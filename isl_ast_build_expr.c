@@ -17,6 +17,9 @@
 #include <isl_ast_build_expr.h>
 #include <isl_ast_private.h>
 #include <isl_ast_build_private.h>
+#include <isl_polynomial_private.h>
+#include <isl_local_space_private.h>
+#include <isl_val_private.h>
 #include <isl_sort.h>
 
 /* Compute the "opposite" of the (numerator of the) argument of a div
@@ -2215,6 +2218,382 @@ __isl_give isl_ast_expr *isl_ast_build_expr_from_pw_aff(
 	return expr;
 }
 
+/* Internal data structure for ast_expr_from_qpolynomial.
+ *
+ * "build" specifies the domain against which the result is simplified.
+ * "ls" is the domain local space of the quasi-polynomial.
+ * "var" contains the AST expressions for those variables of "ls",
+ * including the integer divisions, that have been constructed already.
+ * "den" is the denominator of the quasi-polynomial, i.e.,
+ * the least common multiple of the denominators of its coefficients.
+ */
+struct isl_from_qp_data {
+	isl_ast_build *build;
+	isl_local_space *ls;
+	isl_ast_expr **var;
+	isl_val *den;
+};
+
+/* Return an AST expression for the variable at position "pos"
+ * of the local space data->ls, constructing it if needed.
+ * The expression is constructed using isl_ast_expr_from_aff such that
+ * integer divisions are printed in the same way as in other
+ * AST expressions.
+ */
+static __isl_give isl_ast_expr *qp_var(struct isl_from_qp_data *data, int pos)
+{
+	int i, p;
+	enum isl_dim_type t[] = { isl_dim_param, isl_dim_set, isl_dim_div };
+	isl_aff *aff;
+
+	if (data->var[pos])
+		return isl_ast_expr_copy(data->var[pos]);
+
+	p = pos;
+	for (i = 0; i < 3; ++i) {
+		int n = isl_local_space_dim(data->ls, t[i]);
+		if (p < n)
+			break;
+		p -= n;
+	}
+	if (i >= 3)
+		isl_die(isl_local_space_get_ctx(data->ls), isl_error_internal,
+			"variable out of bounds", return NULL);
+
+	aff = isl_aff_var_on_domain(isl_local_space_copy(data->ls), t[i], p);
+	data->var[pos] = isl_ast_expr_from_aff(aff, data->build);
+	return isl_ast_expr_copy(data->var[pos]);
+}
+
+/* Is "expr" an integer expression with value "v"?
+ */
+static int ast_expr_is_int_si(__isl_keep isl_ast_expr *expr, long v)
+{
+	if (!expr)
+		return -1;
+	if (expr->type != isl_ast_expr_int)
+		return 0;
+	return isl_val_cmp_si(expr->u.v, v) == 0;
+}
+
+/* Create an expression representing the product of "expr" and
+ * the variable at position "pos" of data->ls.
+ */
+static __isl_give isl_ast_expr *ast_expr_mul_var(__isl_take isl_ast_expr *expr,
+	struct isl_from_qp_data *data, int pos)
+{
+	isl_ast_expr *var;
+
+	var = qp_var(data, pos);
+	if (ast_expr_is_int_si(expr, 1) == 1) {
+		isl_ast_expr_free(expr);
+		return var;
+	}
+	if (ast_expr_is_int_si(expr, -1) == 1) {
+		isl_ast_expr_free(expr);
+		return isl_ast_expr_neg(var);
+	}
+	return isl_ast_expr_mul(expr, var);
+}
+
+/* Create an expression representing the sum of "expr1" and "expr2",
+ * turning the addition of a negative integer into a subtraction.
+ */
+static __isl_give isl_ast_expr *ast_expr_add_signed(
+	__isl_take isl_ast_expr *expr1, __isl_take isl_ast_expr *expr2)
+{
+	if (!expr1 || !expr2)
+		goto error;
+
+	if (!ast_expr_is_zero(expr1) && expr2->type == isl_ast_expr_int &&
+	    isl_val_is_neg(expr2->u.v)) {
+		isl_val *v = isl_val_neg(isl_ast_expr_get_val(expr2));
+		isl_ast_expr_free(expr2);
+		return ast_expr_sub(expr1, isl_ast_expr_from_val(v));
+	}
+
+	return ast_expr_add(expr1, expr2);
+error:
+	isl_ast_expr_free(expr1);
+	isl_ast_expr_free(expr2);
+	return NULL;
+}
+
+/* Construct an AST expression for "up", multiplied by data->den,
+ * using Horner's rule.
+ * That is, a polynomial c_0 + c_1 x + ... + c_n x^n in variable x
+ * is evaluated as c_0 + x (c_1 + x (... + x c_n)).
+ */
+static __isl_give isl_ast_expr *ast_expr_from_upoly(
+	__isl_keep struct isl_upoly *up, struct isl_from_qp_data *data)
+{
+	int i;
+	struct isl_upoly_cst *cst;
+	struct isl_upoly_rec *rec;
+	isl_ast_expr *expr;
+	isl_val *v;
+
+	if (isl_upoly_is_cst(up)) {
+		cst = isl_upoly_as_cst(up);
+		if (!cst)
+			return NULL;
+		v = isl_val_rat_from_isl_int(up->ctx, cst->n, cst->d);
+		v = isl_val_mul(v, isl_val_copy(data->den));
+		return isl_ast_expr_from_val(v);
+	}
+
+	rec = isl_upoly_as_rec(up);
+	if (!rec)
+		return NULL;
+
+	expr = ast_expr_from_upoly(rec->p[rec->n - 1], data);
+	for (i = rec->n - 2; i >= 0; --i) {
+		expr = ast_expr_mul_var(expr, data, up->var);
+		expr = ast_expr_add_signed(expr,
+					ast_expr_from_upoly(rec->p[i], data));
+	}
+
+	return expr;
+}
+
+/* Construct an AST expression that evaluates "qp".
+ * The result is simplified in terms of build->domain.
+ *
+ * The quasi-polynomial is first multiplied by its denominator
+ * such that the resulting polynomial can be evaluated in integer
+ * arithmetic, after which the result is divided by this denominator.
+ * The division is exact if "qp" is integer valued
+ * in the points where it is evaluated.
+ *
+ * NaN and infinite values cannot be represented by an AST expression.
+ */
+static __isl_give isl_ast_expr *ast_expr_from_qpolynomial(
+	__isl_keep isl_qpolynomial *qp, __isl_keep isl_ast_build *build)
+{
+	int i, n_var;
+	isl_ctx *ctx;
+	isl_int d;
+	isl_bool special;
+	isl_ast_expr *expr = NULL;
+	struct isl_from_qp_data data;
+
+	if (!qp)
+		return NULL;
+
+	ctx = isl_qpolynomial_get_ctx(qp);
+	special = isl_qpolynomial_is_nan(qp);
+	if (special >= 0 && !special)
+		special = isl_qpolynomial_is_infty(qp);
+	if (special >= 0 && !special)
+		special = isl_qpolynomial_is_neginfty(qp);
+	if (special < 0)
+		return NULL;
+	if (special)
+		isl_die(ctx, isl_error_invalid,
+			"cannot construct AST expression for NaN or infinity",
+			return NULL);
+	data.build = build;
+	data.ls = isl_local_space_alloc_div(isl_space_copy(qp->dim),
+					    isl_mat_copy(qp->div));
+	n_var = isl_local_space_dim(data.ls, isl_dim_all);
+	data.var = isl_calloc_array(ctx, isl_ast_expr *, n_var);
+	isl_int_init(d);
+	isl_qpolynomial_get_den(qp, &d);
+	data.den = isl_val_int_from_isl_int(ctx, d);
+	isl_int_clear(d);
+	if (!data.ls || (n_var && !data.var) || !data.den)
+		goto error;
+
+	expr = ast_expr_from_upoly(qp->upoly, &data);
+	if (!isl_val_is_one(data.den))
+		expr = isl_ast_expr_div(expr,
+				isl_ast_expr_from_val(isl_val_copy(data.den)));
+
+error:
+	for (i = 0; data.var && i < n_var; ++i)
+		isl_ast_expr_free(data.var[i]);
+	free(data.var);
+	isl_local_space_free(data.ls);
+	isl_val_free(data.den);
+	return expr;
+}
+
+/* Construct an AST expression that evaluates "fold".
+ * The result is simplified in terms of build->domain.
+ *
+ * An empty fold evaluates to zero, as in isl_qpolynomial_fold_eval.
+ * A fold with several quasi-polynomials is evaluated as
+ * the minimum or maximum of the individual quasi-polynomials.
+ */
+static __isl_give isl_ast_expr *ast_expr_from_fold(
+	__isl_keep isl_qpolynomial_fold *fold, __isl_keep isl_ast_build *build)
+{
+	int i;
+	isl_ctx *ctx;
+	isl_ast_expr *expr;
+	enum isl_ast_op_type type;
+
+	if (!fold)
+		return NULL;
+
+	ctx = isl_qpolynomial_fold_get_ctx(fold);
+	if (fold->n == 0)
+		return isl_ast_expr_alloc_int_si(ctx, 0);
+	if (fold->n == 1)
+		return ast_expr_from_qpolynomial(fold->qp[0], build);
+
+	type = fold->type == isl_fold_min ? isl_ast_op_min : isl_ast_op_max;
+	expr = isl_ast_expr_alloc_op(ctx, type, fold->n);
+	for (i = 0; i < fold->n; ++i)
+		expr = isl_ast_expr_set_op_arg(expr, i,
+			    ast_expr_from_qpolynomial(fold->qp[i], build));
+
+	return expr;
+}
+
+/* Internal data structure for isl_ast_build_expr_from_pw_qpolynomial_fold.
+ *
+ * "build" specifies the domain against which the result is simplified.
+ * "set" collects the domains of the pieces with a non-zero value and
+ * "expr" the corresponding AST expressions.
+ */
+struct isl_from_pwf_data {
+	isl_ast_build *build;
+	isl_set_list *set;
+	isl_ast_expr_list *expr;
+};
+
+/* Construct an AST expression for "fold" within the domain "set"
+ * and add it to data->expr, unless "fold" is identically zero.
+ * The constraints of "set" are added to the generated constraints
+ * of the build such that they can be exploited to simplify
+ * the AST expression.
+ */
+static isl_stat ast_expr_from_fold_piece(__isl_take isl_set *set,
+	__isl_take isl_qpolynomial_fold *fold, void *user)
+{
+	struct isl_from_pwf_data *data = user;
+	isl_ast_build *build;
+	isl_ast_expr *expr;
+	isl_bool zero;
+
+	if (!fold)
+		zero = isl_bool_error;
+	else if (fold->n == 1)
+		zero = isl_qpolynomial_is_zero(fold->qp[0]);
+	else
+		zero = fold->n == 0 ? isl_bool_true : isl_bool_false;
+	if (zero < 0 || zero) {
+		isl_set_free(set);
+		isl_qpolynomial_fold_free(fold);
+		return zero < 0 ? isl_stat_error : isl_stat_ok;
+	}
+
+	build = isl_ast_build_copy(data->build);
+	build = isl_ast_build_restrict_generated(build, isl_set_copy(set));
+	expr = ast_expr_from_fold(fold, build);
+	isl_ast_build_free(build);
+	isl_qpolynomial_fold_free(fold);
+
+	data->set = isl_set_list_add(data->set, set);
+	data->expr = isl_ast_expr_list_add(data->expr, expr);
+	if (!data->set || !data->expr)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Construct an AST expression that evaluates "pwf".
+ * The result is simplified in terms of build->domain.
+ *
+ * The domain of "pwf" is assumed to live in the schedule space of "build",
+ * which is assumed not to require a schedule map.
+ *
+ * An AST expression is constructed for each piece with a non-zero value.
+ * The pieces are combined into a sequence of select operations
+ * with a condition derived from the domain of the piece.
+ * Since a piecewise quasi-polynomial evaluates to zero
+ * outside of its domain, the final alternative is zero,
+ * unless the pieces cover the entire build domain, in which
+ * case the final piece is evaluated unconditionally.
+ */
+__isl_give isl_ast_expr *isl_ast_build_expr_from_pw_qpolynomial_fold(
+	__isl_keep isl_ast_build *build, __isl_take isl_pw_qpolynomial_fold *pwf)
+{
+	int i, n;
+	isl_ctx *ctx;
+	isl_set *dom, *covered;
+	isl_bool is_covered;
+	isl_ast_expr *res = NULL;
+	struct isl_from_pwf_data data;
+
+	if (!build || !pwf)
+		goto error;
+	ctx = isl_ast_build_get_ctx(build);
+	if (isl_ast_build_need_schedule_map(build))
+		isl_die(ctx, isl_error_unsupported,
+			"build requires schedule map", goto error);
+
+	dom = isl_ast_build_get_domain(build);
+	pwf = isl_pw_qpolynomial_fold_gist(pwf, isl_set_copy(dom));
+	n = isl_pw_qpolynomial_fold_n_piece(pwf);
+	data.build = build;
+	data.set = isl_set_list_alloc(ctx, n);
+	data.expr = isl_ast_expr_list_alloc(ctx, n);
+	if (isl_pw_qpolynomial_fold_foreach_piece(pwf,
+				&ast_expr_from_fold_piece, &data) < 0)
+		dom = isl_set_free(dom);
+
+	n = isl_ast_expr_list_n_ast_expr(data.expr);
+	if (n > 0) {
+		covered = isl_set_list_union(isl_set_list_copy(data.set));
+		is_covered = isl_set_is_subset(dom, covered);
+		isl_set_free(covered);
+	} else {
+		is_covered = dom ? isl_bool_false : isl_bool_error;
+	}
+	isl_set_free(dom);
+
+	if (is_covered >= 0 && n > 0 && is_covered)
+		res = isl_ast_expr_list_get_ast_expr(data.expr, --n);
+	else if (is_covered >= 0)
+		res = isl_ast_expr_alloc_int_si(ctx, 0);
+	for (i = n - 1; i >= 0; --i) {
+		isl_ast_expr *expr, *cond;
+
+		cond = isl_ast_build_expr_from_set(build,
+					isl_set_list_get_set(data.set, i));
+		expr = isl_ast_expr_alloc_op(ctx, isl_ast_op_select, 3);
+		expr = isl_ast_expr_set_op_arg(expr, 0, cond);
+		expr = isl_ast_expr_set_op_arg(expr, 1,
+				isl_ast_expr_list_get_ast_expr(data.expr, i));
+		res = isl_ast_expr_set_op_arg(expr, 2, res);
+	}
+
+	isl_set_list_free(data.set);
+	isl_ast_expr_list_free(data.expr);
+	isl_pw_qpolynomial_fold_free(pwf);
+	return res;
+error:
+	isl_pw_qpolynomial_fold_free(pwf);
+	return NULL;
+}
+
+/* Construct an AST expression that evaluates "pwqp".
+ * The result is simplified in terms of build->domain.
+ *
+ * The domain of "pwqp" is assumed to live in the schedule space of "build",
+ * which is assumed not to require a schedule map.
+ */
+__isl_give isl_ast_expr *isl_ast_build_expr_from_pw_qpolynomial(
+	__isl_keep isl_ast_build *build, __isl_take isl_pw_qpolynomial *pwqp)
+{
+	isl_pw_qpolynomial_fold *pwf;
+
+	pwf = isl_pw_qpolynomial_fold_from_pw_qpolynomial(isl_fold_max, pwqp);
+	return isl_ast_build_expr_from_pw_qpolynomial_fold(build, pwf);
+}
+
 /* Set the ids of the input dimensions of "mpa" to the iterator ids
  * of "build".
  *
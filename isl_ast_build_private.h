@@ -7,6 +7,7 @@
 #include <isl/set.h>
 #include <isl/list.h>
 #include <isl/schedule_node.h>
+#include <isl_ast_graft_private.h>
 
 /* An isl_ast_build represents the context in which AST is being
  * generated.  That is, it (mostly) contains information about outer
@@ -35,6 +36,10 @@
  * it is used as the context argument in a call to isl_basic_set_gist
  * in isl_ast_build_compute_gist_basic_set.
  *
+ * "domain_hull" caches the affine hull of "domain".
+ * It is NULL if it has not been computed yet since "domain" was
+ * last modified.
+ *
  * "depth" is equal to the number of loops that have already
  * been generated (including those in outer AST generations).
  * "outer_pos" is equal to the number of loops in outer AST generations.
@@ -141,6 +146,12 @@
  * "isolated" is the piece of the schedule domain isolated by the isolate
  * option on the current band.  This set may be NULL if we have not checked
  * for the isolate option yet.
+ *
+ * "cache" keeps track of the ASTs that have been generated for
+ * schedule subtrees by this isl_ast_build and by the isl_ast_builds
+ * derived from it.  It is shared by all these isl_ast_builds and
+ * it is NULL if the ast_build_cache option was not set when
+ * the original isl_ast_build was created.
  */
 struct isl_ast_build {
 	int ref;
@@ -151,6 +162,7 @@ struct isl_ast_build {
 	isl_id_list *iterators;
 
 	isl_set *domain;
+	isl_basic_set *domain_hull;
 	isl_set *generated;
 	isl_set *pending;
 	isl_multi_aff *values;
@@ -197,8 +209,20 @@ struct isl_ast_build {
 	int n;
 	enum isl_ast_loop_type *loop_type;
 	isl_set *isolated;
+
+	struct isl_ast_build_cache *cache;
 };
 
+isl_bool isl_ast_build_cache_applies(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_node *node);
+isl_bool isl_ast_build_cache_find(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_node *node, __isl_keep isl_union_map *executed,
+	__isl_give isl_ast_graft_list **list);
+int isl_ast_build_cache_get_n_hit(__isl_keep isl_ast_build *build);
+isl_stat isl_ast_build_cache_add(__isl_keep isl_ast_build *build,
+	__isl_keep isl_schedule_node *node, __isl_keep isl_union_map *executed,
+	__isl_keep isl_ast_graft_list *list);
+
 __isl_give isl_ast_build *isl_ast_build_clear_local_info(
 	__isl_take isl_ast_build *build);
 __isl_give isl_ast_build *isl_ast_build_increase_depth(
@@ -5594,7 +5594,7 @@ static __isl_give isl_ast_graft_list *build_ast_from_sequence(
  * The children of a set node may be executed in any order,
  * including the order of the children.
  */
-static __isl_give isl_ast_graft_list *build_ast_from_schedule_node(
+static __isl_give isl_ast_graft_list *build_ast_from_schedule_node_type(
 	__isl_take isl_ast_build *build, __isl_take isl_schedule_node *node,
 	__isl_take isl_union_map *executed)
 {
@@ -5640,6 +5640,65 @@ error:
 	return NULL;
 }
 
+/* Generate an AST that visits the elements in the domain of "executed"
+ * in the relative order specified by the node "node" and its descendants,
+ * reusing a previously generated AST if possible.
+ *
+ * If the ast_build_cache option was set when the original isl_ast_build
+ * was created, then the ASTs generated for schedule subtrees
+ * are kept track of in a cache that is shared by all isl_ast_builds
+ * derived from this original isl_ast_build.  If an AST has already
+ * been generated for the same subtree, inverse schedule and
+ * AST build state, then a copy of this AST is returned.
+ * Otherwise, the AST is generated by build_ast_from_schedule_node_type and
+ * added to the cache.
+ */
+static __isl_give isl_ast_graft_list *build_ast_from_schedule_node(
+	__isl_take isl_ast_build *build, __isl_take isl_schedule_node *node,
+	__isl_take isl_union_map *executed)
+{
+	isl_bool applies, found;
+	isl_ast_graft_list *list = NULL;
+	isl_ast_build *key_build;
+	isl_schedule_node *key_node;
+	isl_union_map *key_executed;
+
+	applies = isl_ast_build_cache_applies(build, node);
+	if (applies < 0)
+		goto error;
+	if (!applies)
+		return build_ast_from_schedule_node_type(build, node, executed);
+
+	found = isl_ast_build_cache_find(build, node, executed, &list);
+	if (found < 0)
+		goto error;
+	if (found) {
+		isl_ast_build_free(build);
+		isl_schedule_node_free(node);
+		isl_union_map_free(executed);
+		return list;
+	}
+
+	key_build = isl_ast_build_copy(build);
+	key_node = isl_schedule_node_copy(node);
+	key_executed = isl_union_map_copy(executed);
+	list = build_ast_from_schedule_node_type(build, node, executed);
+	if (list &&
+	    isl_ast_build_cache_add(key_build, key_node, key_executed,
+				    list) < 0)
+		list = isl_ast_graft_list_free(list);
+	isl_ast_build_free(key_build);
+	isl_schedule_node_free(key_node);
+	isl_union_map_free(key_executed);
+
+	return list;
+error:
+	isl_ast_build_free(build);
+	isl_schedule_node_free(node);
+	isl_union_map_free(executed);
+	return NULL;
+}
+
 /* Generate an AST that visits the elements in the domain of "executed"
  * in the relative order specified by the (single) child of "node" and
  * its descendants.
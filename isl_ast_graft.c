@@ -98,6 +98,60 @@ static __isl_give isl_ast_graft *isl_ast_graft_copy(
 	return graft;
 }
 
+/* Return a copy of "graft" that does not share any AST nodes with "graft".
+ */
+static __isl_give isl_ast_graft *isl_ast_graft_dup_tree(
+	__isl_keep isl_ast_graft *graft)
+{
+	isl_ctx *ctx;
+	isl_ast_graft *dup;
+
+	if (!graft)
+		return NULL;
+
+	ctx = isl_ast_graft_get_ctx(graft);
+	dup = isl_calloc_type(ctx, isl_ast_graft);
+	if (!dup)
+		return NULL;
+
+	dup->ref = 1;
+	dup->node = isl_ast_node_dup_tree(graft->node);
+	dup->guard = isl_set_copy(graft->guard);
+	dup->enforced = isl_basic_set_copy(graft->enforced);
+
+	if (!dup->node || !dup->guard || !dup->enforced)
+		return isl_ast_graft_free(dup);
+
+	return dup;
+}
+
+/* Return a copy of "list" that does not share any grafts or AST nodes
+ * with "list".
+ * The grafts and their AST nodes are modified in place during
+ * AST generation, so a list that is also kept elsewhere needs
+ * to be copied completely before it can be handed to the AST generator.
+ */
+__isl_give isl_ast_graft_list *isl_ast_graft_list_dup_tree(
+	__isl_keep isl_ast_graft_list *list)
+{
+	int i, n;
+	isl_ast_graft_list *dup;
+
+	if (!list)
+		return NULL;
+
+	n = isl_ast_graft_list_n_ast_graft(list);
+	dup = isl_ast_graft_list_alloc(isl_ast_graft_list_get_ctx(list), n);
+	for (i = 0; i < n; ++i) {
+		isl_ast_graft *graft;
+
+		graft = isl_ast_graft_dup_tree(list->p[i]);
+		dup = isl_ast_graft_list_add(dup, graft);
+	}
+
+	return dup;
+}
+
 /* Do all the grafts in "list" have the same guard and is this guard
  * independent of the current depth?
  */
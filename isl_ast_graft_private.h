@@ -54,6 +54,8 @@ __isl_give isl_ast_graft_list *isl_ast_graft_list_fuse(
 __isl_give isl_ast_graft *isl_ast_graft_alloc_domain(
 	__isl_take isl_map *schedule, __isl_keep isl_ast_build *build);
 void *isl_ast_graft_free(__isl_take isl_ast_graft *graft);
+__isl_give isl_ast_graft_list *isl_ast_graft_list_dup_tree(
+	__isl_keep isl_ast_graft_list *list);
 __isl_give isl_ast_graft_list *isl_ast_graft_list_sort_guard(
 	__isl_take isl_ast_graft_list *list);
 
@@ -85,6 +85,8 @@ struct isl_ast_node {
 	isl_id *annotation;
 };
 
+__isl_give isl_ast_node *isl_ast_node_dup_tree(__isl_keep isl_ast_node *node);
+
 __isl_give isl_ast_node *isl_ast_node_alloc_for(__isl_take isl_id *id);
 __isl_give isl_ast_node *isl_ast_node_for_mark_degenerate(
 	__isl_take isl_ast_node *node);
@@ -23,6 +23,7 @@
 #include <isl_polynomial_private.h>
 #include <isl_options_private.h>
 #include <isl_vec_private.h>
+#include <isl_tab.h>
 #include <isl_bernstein.h>
 
 struct bernstein_data {
@@ -31,6 +32,8 @@ struct bernstein_data {
 	int check_tight;
 
 	isl_cell *cell;
+	isl_set *dom;
+	struct isl_tab *tab;
 
 	isl_qpolynomial_fold *fold;
 	isl_qpolynomial_fold *fold_tight;
@@ -119,11 +122,11 @@ static void add_fold(__isl_take isl_qpolynomial *b, __isl_keep isl_set *dom,
 	fold = isl_qpolynomial_fold_alloc(data->type, b);
 
 	if (data->check_tight && is_tight(k, n, d, data->cell))
-		data->fold_tight = isl_qpolynomial_fold_fold_on_domain(dom,
-							data->fold_tight, fold);
+		data->fold_tight = isl_qpolynomial_fold_fold_on_domain_tab(dom,
+					data->tab, data->fold_tight, fold);
 	else
-		data->fold = isl_qpolynomial_fold_fold_on_domain(dom,
-							data->fold, fold);
+		data->fold = isl_qpolynomial_fold_fold_on_domain_tab(dom,
+					data->tab, data->fold, fold);
 }
 
 /* Extract the coefficients of the Bernstein base polynomials and store
@@ -231,7 +234,9 @@ error:
 }
 
 /* Perform bernstein expansion on the parametric vertices that are active
- * on "cell".
+ * on "cell" and add the coefficients to data->fold and data->fold_tight.
+ * The domain of "cell" is data->dom, with tableau representation data->tab
+ * (if not NULL).
  *
  * data->poly has been homogenized in the calling function.
  *
@@ -253,8 +258,6 @@ static isl_stat bernstein_coefficients_cell(__isl_take isl_cell *cell,
 	unsigned nvar;
 	int n_vertices;
 	isl_qpolynomial **subs;
-	isl_pw_qpolynomial_fold *pwf;
-	isl_set *dom;
 	isl_ctx *ctx;
 
 	if (!poly)
@@ -264,10 +267,6 @@ static isl_stat bernstein_coefficients_cell(__isl_take isl_cell *cell,
 	n_vertices = cell->n_vertices;
 
 	ctx = isl_qpolynomial_get_ctx(poly);
-	if (n_vertices > nvar + 1 && ctx->opt->bernstein_triangulate)
-		return isl_cell_foreach_simplex(cell,
-					    &bernstein_coefficients_cell, user);
-
 	subs = isl_alloc_array(ctx, isl_qpolynomial *, 1 + nvar);
 	if (!subs)
 		goto error;
@@ -296,6 +295,7 @@ static isl_stat bernstein_coefficients_cell(__isl_take isl_cell *cell,
 		subs[0] = isl_qpolynomial_add(subs[0], c);
 	}
 	isl_space_free(dim_dst);
+	isl_space_free(dim_param);
 
 	poly = isl_qpolynomial_copy(poly);
 
@@ -304,16 +304,7 @@ static isl_stat bernstein_coefficients_cell(__isl_take isl_cell *cell,
 	poly = isl_qpolynomial_drop_dims(poly, isl_dim_in, 0, 1 + nvar);
 
 	data->cell = cell;
-	dom = isl_set_from_basic_set(isl_basic_set_copy(cell->dom));
-	data->fold = isl_qpolynomial_fold_empty(data->type, isl_space_copy(dim_param));
-	data->fold_tight = isl_qpolynomial_fold_empty(data->type, dim_param);
-	extract_coefficients(poly, dom, data);
-
-	pwf = isl_pw_qpolynomial_fold_alloc(data->type, isl_set_copy(dom),
-					    data->fold);
-	data->pwf = isl_pw_qpolynomial_fold_fold(data->pwf, pwf);
-	pwf = isl_pw_qpolynomial_fold_alloc(data->type, dom, data->fold_tight);
-	data->pwf_tight = isl_pw_qpolynomial_fold_fold(data->pwf_tight, pwf);
+	extract_coefficients(poly, data->dom, data);
 
 	isl_qpolynomial_free(poly);
 	isl_cell_free(cell);
@@ -326,6 +317,84 @@ error:
 	return isl_stat_error;
 }
 
+/* Perform bernstein expansion on the chamber "cell" and add the result
+ * to data->pwf and data->pwf_tight.
+ *
+ * If there are more active vertices than needed to span a simplex
+ * and if the bernstein_triangulate option is set, then the chamber
+ * is triangulated and bernstein expansion is performed on each simplex.
+ * These simplices all share the domain of the chamber, so
+ * the coefficients of all simplices are collected in a single reduction
+ * over this domain.
+ *
+ * The coefficients are combined into a reduction by comparing them
+ * pairwise, which requires solving many LP problems over the same domain.
+ * If the domain does not involve any existentially quantified variables,
+ * then a tableau representation of the domain is constructed once and
+ * reused for all these LP problems.
+ *
+ * The chambers are disjoint, so the reductions can simply be
+ * added to data->pwf and data->pwf_tight as separate pieces.
+ * Making the chambers disjoint may result in some of them
+ * not containing any integer points.  Such chambers are skipped.
+ */
+static isl_stat bernstein_coefficients_chamber(__isl_take isl_cell *cell,
+	void *user)
+{
+	struct bernstein_data *data = (struct bernstein_data *)user;
+	isl_space *space;
+	isl_pw_qpolynomial_fold *pwf;
+	isl_ctx *ctx;
+	unsigned nvar;
+	isl_bool empty;
+	isl_stat r;
+
+	if (!cell || !data->poly)
+		goto error;
+
+	empty = isl_basic_set_is_empty(cell->dom);
+	if (empty < 0)
+		goto error;
+	if (empty) {
+		isl_cell_free(cell);
+		return isl_stat_ok;
+	}
+
+	nvar = isl_qpolynomial_dim(data->poly, isl_dim_in) - 1;
+	ctx = isl_qpolynomial_get_ctx(data->poly);
+
+	space = isl_basic_set_get_space(cell->dom);
+	data->dom = isl_set_from_basic_set(isl_basic_set_copy(cell->dom));
+	data->tab = NULL;
+	if (cell->dom->n_div == 0)
+		data->tab = isl_tab_from_basic_set(cell->dom, 0);
+	data->fold = isl_qpolynomial_fold_empty(data->type,
+						isl_space_copy(space));
+	data->fold_tight = isl_qpolynomial_fold_empty(data->type, space);
+
+	if (cell->n_vertices > nvar + 1 && ctx->opt->bernstein_triangulate)
+		r = isl_cell_foreach_simplex(cell,
+					    &bernstein_coefficients_cell, user);
+	else
+		r = bernstein_coefficients_cell(cell, user);
+
+	isl_tab_free(data->tab);
+	data->tab = NULL;
+
+	pwf = isl_pw_qpolynomial_fold_alloc(data->type,
+				isl_set_copy(data->dom), data->fold);
+	data->pwf = isl_pw_qpolynomial_fold_add_disjoint(data->pwf, pwf);
+	pwf = isl_pw_qpolynomial_fold_alloc(data->type, data->dom,
+				data->fold_tight);
+	data->pwf_tight = isl_pw_qpolynomial_fold_add_disjoint(data->pwf_tight,
+				pwf);
+
+	return r;
+error:
+	isl_cell_free(cell);
+	return isl_stat_error;
+}
+
 /* Base case of applying bernstein expansion.
  *
  * We compute the chamber decomposition of the parametric polytope "bset"
@@ -375,7 +444,7 @@ static __isl_give isl_pw_qpolynomial_fold *bernstein_coefficients_base(
 	data->poly = isl_qpolynomial_homogenize(isl_qpolynomial_copy(poly));
 	vertices = isl_basic_set_compute_vertices(bset);
 	if (isl_vertices_foreach_disjoint_cell(vertices,
-					&bernstein_coefficients_cell, data) < 0)
+				&bernstein_coefficients_chamber, data) < 0)
 		data->pwf = isl_pw_qpolynomial_fold_free(data->pwf);
 	isl_vertices_free(vertices);
 	isl_qpolynomial_free(data->poly);
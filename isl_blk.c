@@ -46,22 +46,40 @@ static void isl_blk_free_force(struct isl_ctx *ctx, struct isl_blk block)
 	for (i = 0; i < block.size; ++i)
 		isl_int_clear(block.data[i]);
 	free(block.data);
+	isl_ctx_remove_memory(ctx, block.size * sizeof(isl_int));
 }
 
+/* Extend "block" to hold (at least) "new_n" elements.
+ *
+ * The memory occupied by the elements of blocks is tracked by "ctx"
+ * such that the computation can be aborted when the memory budget
+ * is exceeded.  The generic isl_realloc_or_die is not used here
+ * because it would compare the entire new size against the remaining
+ * budget, while only the size of the extension is new.
+ */
 static struct isl_blk extend(struct isl_ctx *ctx, struct isl_blk block,
 				size_t new_n)
 {
 	int i;
 	isl_int *p;
+	size_t extra;
 
 	if (block.size >= new_n)
 		return block;
 
-	p = isl_realloc_array(ctx, block.data, isl_int, new_n);
-	if (!p) {
+	extra = (new_n - block.size) * sizeof(isl_int);
+	if (isl_ctx_next_operation(ctx) < 0 ||
+	    isl_ctx_add_memory(ctx, extra) < 0) {
 		isl_blk_free_force(ctx, block);
 		return isl_blk_error();
 	}
+	p = realloc(block.data, new_n * sizeof(isl_int));
+	if (!p) {
+		isl_ctx_remove_memory(ctx, extra);
+		isl_blk_free_force(ctx, block);
+		isl_die(ctx, isl_error_alloc, "allocation failure",
+			return isl_blk_error());
+	}
 	block.data = p;
 
 	for (i = block.size; i < new_n; ++i)
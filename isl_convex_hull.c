@@ -1932,6 +1932,227 @@ struct isl_basic_set *isl_set_convex_hull(struct isl_set *set)
 	return bset_from_bmap(isl_map_convex_hull(set_to_map(set)));
 }
 
+/* Add those inequality constraints of "bset" that are valid
+ * for all elements of the rational tableau "tab" to "hull",
+ * skipping those that already appear in "hull".
+ * Set *all to 0 if any of the constraints is not valid for "tab".
+ */
+static __isl_give isl_basic_set *add_valid_inequalities(
+	__isl_take isl_basic_set *hull, __isl_keep isl_basic_set *bset,
+	struct isl_tab *tab, int *all)
+{
+	int i, j, k;
+	unsigned total;
+
+	if (!hull)
+		return NULL;
+
+	total = isl_basic_set_total_dim(bset);
+	for (i = 0; i < bset->n_ineq; ++i) {
+		enum isl_ineq_type type;
+
+		type = isl_tab_ineq_type(tab, bset->ineq[i]);
+		if (type == isl_ineq_error)
+			return isl_basic_set_free(hull);
+		if (type != isl_ineq_redundant) {
+			*all = 0;
+			continue;
+		}
+		for (j = 0; j < hull->n_ineq; ++j)
+			if (isl_seq_eq(hull->ineq[j], bset->ineq[i], 1 + total))
+				break;
+		if (j < hull->n_ineq)
+			continue;
+		k = isl_basic_set_alloc_inequality(hull);
+		if (k < 0)
+			return isl_basic_set_free(hull);
+		isl_seq_cpy(hull->ineq[k], bset->ineq[i], 1 + total);
+	}
+
+	return hull;
+}
+
+/* Compute the convex hull of the union of "bset1" and "bset2",
+ * which are rational, bounded and full-dimensional basic sets
+ * without parameters, integer divisions or redundant constraints
+ * that live in the same space.
+ *
+ * Since the constraints of "bset1" and "bset2" are facets,
+ * any of those constraints that is also valid for the other
+ * basic set is a facet of the convex hull.
+ * In particular, if all constraints of one basic set are valid
+ * for the other, then the first basic set contains the second
+ * and is therefore the convex hull.
+ * Otherwise, the facets found in this way are used as the starting
+ * point for "extend", which then only needs to find the remaining facets.
+ * If "bset1" is the convex hull of some earlier collection of sets,
+ * then the facets of this earlier convex hull that are not affected
+ * by "bset2" are reused rather than recomputed through wrapping and
+ * the wrapping LPs only involve two basic sets.
+ */
+static __isl_give isl_basic_set *uset_union_convex_hull(
+	__isl_take isl_basic_set *bset1, __isl_take isl_basic_set *bset2)
+{
+	int all;
+	struct isl_tab *tab1 = NULL, *tab2 = NULL;
+	isl_basic_set *hull;
+	isl_set *set;
+
+	if (!bset1 || !bset2)
+		goto error;
+
+	tab1 = isl_tab_from_basic_set(bset1, 0);
+	tab2 = isl_tab_from_basic_set(bset2, 0);
+	if (!tab1 || !tab2)
+		goto error;
+	hull = isl_basic_set_alloc_space(isl_basic_set_get_space(bset1),
+				0, 0, bset1->n_ineq + bset2->n_ineq);
+	hull = isl_basic_set_set_rational(hull);
+	all = 1;
+	hull = add_valid_inequalities(hull, bset1, tab2, &all);
+	if (hull && all) {
+		isl_basic_set_free(hull);
+		isl_tab_free(tab1);
+		isl_tab_free(tab2);
+		isl_basic_set_free(bset2);
+		return bset1;
+	}
+	all = 1;
+	hull = add_valid_inequalities(hull, bset2, tab1, &all);
+	isl_tab_free(tab1);
+	isl_tab_free(tab2);
+	if (hull && all) {
+		isl_basic_set_free(hull);
+		isl_basic_set_free(bset1);
+		return bset2;
+	}
+
+	set = isl_basic_set_union(bset1, bset2);
+	if (!set)
+		return isl_basic_set_free(hull);
+	if (hull && hull->n_ineq == 0)
+		hull = initial_hull(hull, set);
+	hull = extend(hull, set);
+	isl_set_free(set);
+
+	return hull;
+error:
+	isl_tab_free(tab1);
+	isl_tab_free(tab2);
+	isl_basic_set_free(bset1);
+	isl_basic_set_free(bset2);
+	return NULL;
+}
+
+/* Can the convex hull of the union of "bmap1" and "bmap2" be computed
+ * using uset_union_convex_hull, provided they are bounded?
+ * That is, do "bmap1" and "bmap2" live in the same space and
+ * are they full-dimensional basic maps without integer divisions?
+ * The caller is assumed to have removed the redundant constraints
+ * and to have detected the implicit equalities.
+ * The wrapping based convex hull computation is only used
+ * if it has been selected by the user.
+ */
+static int union_convex_hull_may_wrap(__isl_keep isl_basic_map *bmap1,
+	__isl_keep isl_basic_map *bmap2)
+{
+	if (bmap1->ctx->opt->convex != ISL_CONVEX_HULL_WRAP)
+		return 0;
+	if (!isl_space_is_equal(bmap1->dim, bmap2->dim))
+		return 0;
+	if (bmap1->n_div != 0 || bmap2->n_div != 0)
+		return 0;
+	if (bmap1->n_eq != 0 || bmap2->n_eq != 0)
+		return 0;
+	if (ISL_F_ISSET(bmap1, ISL_BASIC_MAP_EMPTY) ||
+	    ISL_F_ISSET(bmap2, ISL_BASIC_MAP_EMPTY))
+		return 0;
+	return isl_basic_map_total_dim(bmap1) >= 2;
+}
+
+/* Compute the convex hull of the union of "bmap1" and "bmap2".
+ *
+ * The inputs are treated as rational basic maps, i.e., the result
+ * is the convex hull of the union of the rational relaxations
+ * of "bmap1" and "bmap2".  In particular, the inputs are marked
+ * rational before their redundant constraints are removed.
+ * Removing redundant constraints from an integer basic map
+ * may remove constraints that are only redundant for the integer
+ * points and would therefore enlarge the rational relaxation.
+ * After marking, the remaining constraints are all facets,
+ * so that any of them that is also valid for the other input
+ * is a facet of the convex hull.
+ *
+ * If "bmap1" is itself the result of a convex hull computation,
+ * then the facets of this convex hull can be reused in the common case
+ * where both inputs are bounded and full-dimensional.
+ * This allows the convex hull of a collection of basic maps
+ * that grows one basic map at a time to be maintained incrementally,
+ * with the same result as computing the convex hull
+ * of the rational relaxation of the entire collection at once.
+ * In particular, if one of the inputs contains the other,
+ * then it is returned without any further computation.
+ * Since the parameters are treated as ordinary variables
+ * in the underlying sets, they also need to be bounded.
+ * In all other cases, the result is computed by isl_map_convex_hull
+ * on the union of the rational inputs.
+ */
+__isl_give isl_basic_map *isl_basic_map_union_convex_hull(
+	__isl_take isl_basic_map *bmap1, __isl_take isl_basic_map *bmap2)
+{
+	isl_bool bounded = isl_bool_false;
+	isl_basic_map *model;
+	isl_basic_set *bset1 = NULL, *bset2 = NULL, *hull;
+	isl_map *map;
+
+	bmap1 = isl_basic_map_set_rational(bmap1);
+	bmap2 = isl_basic_map_set_rational(bmap2);
+	bmap1 = isl_basic_map_remove_redundancies(bmap1);
+	bmap2 = isl_basic_map_remove_redundancies(bmap2);
+	if (!bmap1 || !bmap2)
+		goto error;
+
+	if (union_convex_hull_may_wrap(bmap1, bmap2)) {
+		bset1 = isl_basic_map_underlying_set(isl_basic_map_copy(bmap1));
+		bset2 = isl_basic_map_underlying_set(isl_basic_map_copy(bmap2));
+		bounded = isl_basic_set_is_bounded(bset1);
+		if (bounded == isl_bool_true)
+			bounded = isl_basic_set_is_bounded(bset2);
+	}
+	if (bounded != isl_bool_true) {
+		isl_basic_set_free(bset1);
+		isl_basic_set_free(bset2);
+		if (bounded < 0)
+			goto error;
+		map = isl_map_from_basic_map(bmap1);
+		map = isl_map_union(map, isl_map_from_basic_map(bmap2));
+		return isl_map_convex_hull(map);
+	}
+
+	model = bmap1;
+	isl_basic_map_free(bmap2);
+	hull = uset_union_convex_hull(bset1, bset2);
+	bmap1 = isl_basic_map_overlying_set(hull, model);
+	if (!bmap1)
+		return NULL;
+
+	ISL_F_SET(bmap1, ISL_BASIC_MAP_NO_IMPLICIT);
+	ISL_F_SET(bmap1, ISL_BASIC_MAP_ALL_EQUALITIES);
+	ISL_F_CLR(bmap1, ISL_BASIC_MAP_RATIONAL);
+	return bmap1;
+error:
+	isl_basic_map_free(bmap1);
+	isl_basic_map_free(bmap2);
+	return NULL;
+}
+
+__isl_give isl_basic_set *isl_basic_set_union_convex_hull(
+	__isl_take isl_basic_set *bset1, __isl_take isl_basic_set *bset2)
+{
+	return bset_from_bmap(isl_basic_map_union_convex_hull(
+				bset_to_bmap(bset1), bset_to_bmap(bset2)));
+}
+
 __isl_give isl_basic_map *isl_map_polyhedral_hull(__isl_take isl_map *map)
 {
 	isl_basic_map *hull;
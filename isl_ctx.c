@@ -7,6 +7,7 @@
  * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
  */
 
+#include <stdint.h>
 #include <isl_ctx_private.h>
 #include <isl/vec.h>
 #include <isl_options_private.h>
@@ -55,6 +56,85 @@ int isl_ctx_next_operation(isl_ctx *ctx)
 	return 0;
 }
 
+/* Is there room for an additional "size" bytes of memory
+ * within the memory budget of "ctx"?
+ */
+static int fits_memory(isl_ctx *ctx, size_t size)
+{
+	if (!ctx->max_memory)
+		return 1;
+	if (ctx->memory > ctx->max_memory)
+		return 0;
+	return size <= ctx->max_memory - ctx->memory;
+}
+
+/* Compute the size of an allocation of "nmemb" elements
+ * of "size" bytes each and store it in "total".
+ * Complain if the size cannot be represented.
+ * Return 0 on success and -1 on overflow.
+ */
+static int array_size(isl_ctx *ctx, size_t nmemb, size_t size, size_t *total)
+{
+	if (size != 0 && nmemb > SIZE_MAX / size)
+		isl_die(ctx, isl_error_alloc,
+			"allocation size overflow", return -1);
+	*total = nmemb * size;
+	return 0;
+}
+
+/* Check that an allocation of "size" bytes fits within
+ * the memory budget of "ctx" and complain if it does not.
+ * Return 0 if the allocation can proceed and -1 otherwise.
+ *
+ * Memory allocated through the generic allocation functions
+ * is released through a plain call to free, so its size
+ * cannot be taken into account in the tracked memory usage.
+ * We can however still refuse any single allocation that would
+ * not fit in what remains of the budget.
+ */
+static int check_memory(isl_ctx *ctx, size_t size)
+{
+	if (!ctx)
+		return -1;
+	if (!fits_memory(ctx, size))
+		isl_die(ctx, isl_error_quota,
+			"maximal amount of memory exceeded", return -1);
+	return 0;
+}
+
+/* Record that "size" additional bytes of memory are being used
+ * by objects in "ctx" and update the peak memory usage.
+ * Return 0 if this still fits within the memory budget and
+ * return -1 (without recording the memory) if it does not.
+ * Before giving up, release the memory held by the block cache,
+ * since that memory is not in active use.
+ */
+int isl_ctx_add_memory(isl_ctx *ctx, size_t size)
+{
+	if (!ctx)
+		return -1;
+	if (!fits_memory(ctx, size))
+		isl_blk_clear_cache(ctx);
+	if (check_memory(ctx, size) < 0)
+		return -1;
+	ctx->memory += size;
+	if (ctx->memory > ctx->peak_memory)
+		ctx->peak_memory = ctx->memory;
+	return 0;
+}
+
+/* Record that "size" bytes of memory tracked by "ctx" have been released.
+ */
+void isl_ctx_remove_memory(isl_ctx *ctx, size_t size)
+{
+	if (!ctx)
+		return;
+	if (size > ctx->memory)
+		ctx->memory = 0;
+	else
+		ctx->memory -= size;
+}
+
 /* Call malloc and complain if it fails.
  * If ctx is NULL, then return NULL.
  */
@@ -62,7 +142,9 @@ void *isl_malloc_or_die(isl_ctx *ctx, size_t size)
 {
 	if (isl_ctx_next_operation(ctx) < 0)
 		return NULL;
-	return ctx ? check_non_null(ctx, malloc(size), size) : NULL;
+	if (check_memory(ctx, size) < 0)
+		return NULL;
+	return check_non_null(ctx, malloc(size), size);
 }
 
 /* Call calloc and complain if it fails.
@@ -70,9 +152,30 @@ void *isl_malloc_or_die(isl_ctx *ctx, size_t size)
  */
 void *isl_calloc_or_die(isl_ctx *ctx, size_t nmemb, size_t size)
 {
+	size_t total;
+
 	if (isl_ctx_next_operation(ctx) < 0)
 		return NULL;
-	return ctx ? check_non_null(ctx, calloc(nmemb, size), nmemb) : NULL;
+	if (array_size(ctx, nmemb, size, &total) < 0)
+		return NULL;
+	if (check_memory(ctx, total) < 0)
+		return NULL;
+	return check_non_null(ctx, calloc(nmemb, size), nmemb);
+}
+
+/* Call malloc for an array of "nmemb" elements of "size" bytes each
+ * and complain if it fails or if the size of the array overflows.
+ * If ctx is NULL, then return NULL.
+ */
+void *isl_malloc_array_or_die(isl_ctx *ctx, size_t nmemb, size_t size)
+{
+	size_t total;
+
+	if (!ctx)
+		return NULL;
+	if (array_size(ctx, nmemb, size, &total) < 0)
+		return NULL;
+	return isl_malloc_or_die(ctx, total);
 }
 
 /* Call realloc and complain if it fails.
@@ -82,7 +185,25 @@ void *isl_realloc_or_die(isl_ctx *ctx, void *ptr, size_t size)
 {
 	if (isl_ctx_next_operation(ctx) < 0)
 		return NULL;
-	return ctx ? check_non_null(ctx, realloc(ptr, size), size) : NULL;
+	if (check_memory(ctx, size) < 0)
+		return NULL;
+	return check_non_null(ctx, realloc(ptr, size), size);
+}
+
+/* Call realloc for an array of "nmemb" elements of "size" bytes each
+ * and complain if it fails or if the size of the array overflows.
+ * If ctx is NULL, then return NULL.
+ */
+void *isl_realloc_array_or_die(isl_ctx *ctx, void *ptr, size_t nmemb,
+	size_t size)
+{
+	size_t total;
+
+	if (!ctx)
+		return NULL;
+	if (array_size(ctx, nmemb, size, &total) < 0)
+		return NULL;
+	return isl_realloc_or_die(ctx, ptr, total);
 }
 
 void isl_handle_error(isl_ctx *ctx, enum isl_error error, const char *msg,
@@ -207,6 +328,10 @@ isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 	ctx->operations = 0;
 	isl_ctx_set_max_operations(ctx, ctx->opt->max_operations);
 
+	ctx->memory = 0;
+	ctx->peak_memory = 0;
+	isl_ctx_set_max_memory(ctx, ctx->opt->max_memory);
+
 	return ctx;
 error:
 	isl_args_free(args, user_opt);
@@ -241,12 +366,14 @@ void isl_ctx_deref(struct isl_ctx *ctx)
 static void print_stats(isl_ctx *ctx)
 {
 	fprintf(stderr, "operations: %lu\n", ctx->operations);
+	fprintf(stderr, "peak memory: %lu\n", ctx->peak_memory);
 }
 
 void isl_ctx_free(struct isl_ctx *ctx)
 {
 	if (!ctx)
 		return;
+	isl_ctx_clear_closure_cache(ctx);
 	if (ctx->ref != 0)
 		isl_die(ctx, isl_error_invalid,
 			"isl_ctx freed, but some objects still reference it",
@@ -340,3 +467,46 @@ void isl_ctx_reset_operations(isl_ctx *ctx)
 		return;
 	ctx->operations = 0;
 }
+
+/* Set the maximal number of bytes of tracked memory
+ * that can be in use by "ctx" to "max_memory".
+ * A value of zero means that no bound is imposed.
+ */
+void isl_ctx_set_max_memory(isl_ctx *ctx, unsigned long max_memory)
+{
+	if (!ctx)
+		return;
+	ctx->max_memory = max_memory;
+}
+
+/* Return the maximal number of bytes of tracked memory of "ctx".
+ */
+unsigned long isl_ctx_get_max_memory(isl_ctx *ctx)
+{
+	return ctx ? ctx->max_memory : 0;
+}
+
+/* Return the number of bytes of tracked memory currently in use by "ctx".
+ */
+unsigned long isl_ctx_get_memory(isl_ctx *ctx)
+{
+	return ctx ? ctx->memory : 0;
+}
+
+/* Return the maximal number of bytes of tracked memory
+ * that have been in use by "ctx" at any one time since
+ * its creation or since the last call to isl_ctx_reset_peak_memory.
+ */
+unsigned long isl_ctx_get_peak_memory(isl_ctx *ctx)
+{
+	return ctx ? ctx->peak_memory : 0;
+}
+
+/* Reset the peak memory usage of "ctx" to the current memory usage.
+ */
+void isl_ctx_reset_peak_memory(isl_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	ctx->peak_memory = ctx->memory;
+}
@@ -23,12 +23,23 @@ struct isl_ctx {
 	struct isl_blk		cache[ISL_BLK_CACHE_SIZE];
 	struct isl_hash_table	id_table;
 
+	struct isl_closure_cache	*closure_cache;
+
 	enum isl_error		error;
 
 	int			abort;
 
 	unsigned long		operations;
 	unsigned long		max_operations;
+
+	unsigned long		memory;
+	unsigned long		peak_memory;
+	unsigned long		max_memory;
 };
 
 int isl_ctx_next_operation(isl_ctx *ctx);
+int isl_ctx_add_memory(isl_ctx *ctx, size_t size);
+void isl_ctx_remove_memory(isl_ctx *ctx, size_t size);
+
+int isl_ctx_get_closure_cache_n_hit(isl_ctx *ctx);
+
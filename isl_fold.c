@@ -16,6 +16,7 @@
 #include <isl_space_private.h>
 #include <isl_lp_private.h>
 #include <isl_seq.h>
+#include <isl_tab.h>
 #include <isl_mat_private.h>
 #include <isl_val_private.h>
 #include <isl_vec_private.h>
@@ -267,8 +268,47 @@ static int isl_qpolynomial_cst_sign(__isl_keep isl_qpolynomial *qp)
 	return isl_int_sgn(cst->n) < 0 ? -1 : 1;
 }
 
+/* Compute the minimum (or maximum if "max" is set) of the affine
+ * expression "f" with denominator "d" over "set", rounded up (or down)
+ * to the nearest integer, and store it in *opt.
+ *
+ * If "tab" is not NULL, then it is a tableau representation of "set"
+ * and the optimum is computed in this tableau, avoiding the construction
+ * of a new tableau for each optimization problem.
+ * This is only valid because isl_set_solve_lp also solves
+ * the problem using isl_tab_min.  If isl_set_solve_lp were ever
+ * to support other LP solvers, then "tab" should only be used
+ * if the tableau based solver is selected.
+ */
+static enum isl_lp_result solve_lp(__isl_keep isl_set *set,
+	struct isl_tab *tab, int max, isl_int *f, isl_int d, isl_int *opt)
+{
+	enum isl_lp_result res;
+
+	if (!tab)
+		return isl_set_solve_lp(set, max, f, d, opt, NULL, NULL);
+
+	if (max)
+		isl_seq_neg(f, f, 1 + tab->n_var);
+	res = isl_tab_min(tab, f, d, opt, NULL, 0);
+	if (max)
+		isl_seq_neg(f, f, 1 + tab->n_var);
+	if (max)
+		isl_int_neg(*opt, *opt);
+
+	return res;
+}
+
+/* Determine the sign of the affine quasipolynomial "qp" on
+ * the domain "set", with optional tableau representation "tab".
+ *
+ * Return
+ *	-1 if qp <= 0
+ *	 1 if qp >= 0
+ *	 0 if unknown
+ */
 static int isl_qpolynomial_aff_sign(__isl_keep isl_set *set,
-	__isl_keep isl_qpolynomial *qp)
+	struct isl_tab *tab, __isl_keep isl_qpolynomial *qp)
 {
 	enum isl_lp_result res;
 	isl_vec *aff;
@@ -281,8 +321,7 @@ static int isl_qpolynomial_aff_sign(__isl_keep isl_set *set,
 
 	isl_int_init(opt);
 
-	res = isl_set_solve_lp(set, 0, aff->el + 1, aff->el[0],
-				&opt, NULL, NULL);
+	res = solve_lp(set, tab, 0, aff->el + 1, aff->el[0], &opt);
 	if (res == isl_lp_error)
 		goto done;
 	if (res == isl_lp_empty ||
@@ -291,8 +330,7 @@ static int isl_qpolynomial_aff_sign(__isl_keep isl_set *set,
 		goto done;
 	}
 
-	res = isl_set_solve_lp(set, 1, aff->el + 1, aff->el[0],
-				&opt, NULL, NULL);
+	res = solve_lp(set, tab, 1, aff->el + 1, aff->el[0], &opt);
 	if (res == isl_lp_ok && !isl_int_is_pos(opt))
 		sgn = -1;
 
@@ -304,6 +342,7 @@ done:
 
 /* Determine, if possible, the sign of the quasipolynomial "qp" on
  * the domain "set".
+ * If "tab" is not NULL, then it is a tableau representation of "set".
  *
  * If qp is a constant, then the problem is trivial.
  * If qp is linear, then we check if the minimum of the corresponding
@@ -323,7 +362,7 @@ done:
  *	 0 if unknown
  */
 static int isl_qpolynomial_sign(__isl_keep isl_set *set,
-	__isl_keep isl_qpolynomial *qp)
+	struct isl_tab *tab, __isl_keep isl_qpolynomial *qp)
 {
 	int d;
 	int i;
@@ -344,7 +383,7 @@ static int isl_qpolynomial_sign(__isl_keep isl_set *set,
 	if (is < 0)
 		return 0;
 	if (is)
-		return isl_qpolynomial_aff_sign(set, qp);
+		return isl_qpolynomial_aff_sign(set, tab, qp);
 
 	if (qp->div->n_row > 0)
 		return 0;
@@ -354,7 +393,7 @@ static int isl_qpolynomial_sign(__isl_keep isl_set *set,
 		return 0;
 
 	d = isl_space_dim(qp->dim, isl_dim_all);
-	v = isl_vec_alloc(set->ctx, 2 + d);
+	v = isl_vec_alloc(qp->dim->ctx, 2 + d);
 	if (!v)
 		return 0;
 
@@ -364,7 +403,7 @@ static int isl_qpolynomial_sign(__isl_keep isl_set *set,
 
 	isl_int_init(l);
 
-	res = isl_set_solve_lp(set, 0, v->el + 1, v->el[0], &l, NULL, NULL);
+	res = solve_lp(set, tab, 0, v->el + 1, v->el[0], &l);
 	if (res == isl_lp_ok) {
 		isl_qpolynomial *min;
 		isl_qpolynomial *base;
@@ -391,13 +430,13 @@ static int isl_qpolynomial_sign(__isl_keep isl_set *set,
 		}
 
 		if (isl_qpolynomial_is_zero(q))
-			sgn = isl_qpolynomial_sign(set, r);
+			sgn = isl_qpolynomial_sign(set, tab, r);
 		else if (isl_qpolynomial_is_zero(r))
-			sgn = isl_qpolynomial_sign(set, q);
+			sgn = isl_qpolynomial_sign(set, tab, q);
 		else {
 			int sgn_q, sgn_r;
-			sgn_r = isl_qpolynomial_sign(set, r);
-			sgn_q = isl_qpolynomial_sign(set, q);
+			sgn_r = isl_qpolynomial_sign(set, tab, r);
+			sgn_q = isl_qpolynomial_sign(set, tab, q);
 			if (sgn_r == sgn_q)
 				sgn = sgn_r;
 		}
@@ -418,13 +457,15 @@ static int isl_qpolynomial_sign(__isl_keep isl_set *set,
 /* Combine "fold1" and "fold2" into a single reduction, eliminating
  * those elements of one reduction that are already covered by the other
  * reduction on "set".
+ * If "tab" is not NULL, then it is a tableau representation of "set"
+ * that is used to determine the signs of the differences of the elements.
  *
  * If "fold1" or "fold2" is an empty reduction, then return
  * the other reduction.
  * If "fold1" or "fold2" is a NaN, then return this NaN.
  */
-__isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_fold_on_domain(
-	__isl_keep isl_set *set,
+__isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_fold_on_domain_tab(
+	__isl_keep isl_set *set, struct isl_tab *tab,
 	__isl_take isl_qpolynomial_fold *fold1,
 	__isl_take isl_qpolynomial_fold *fold2)
 {
@@ -480,7 +521,7 @@ __isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_fold_on_domain(
 			d = isl_qpolynomial_sub(
 				isl_qpolynomial_copy(res->qp[j]),
 				isl_qpolynomial_copy(fold2->qp[i]));
-			sgn = isl_qpolynomial_sign(set, d);
+			sgn = isl_qpolynomial_sign(set, tab, d);
 			isl_qpolynomial_free(d);
 			if (sgn == 0)
 				continue;
@@ -513,6 +554,19 @@ error:
 	return NULL;
 }
 
+/* Combine "fold1" and "fold2" into a single reduction, eliminating
+ * those elements of one reduction that are already covered by the other
+ * reduction on "set".
+ */
+__isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_fold_on_domain(
+	__isl_keep isl_set *set,
+	__isl_take isl_qpolynomial_fold *fold1,
+	__isl_take isl_qpolynomial_fold *fold2)
+{
+	return isl_qpolynomial_fold_fold_on_domain_tab(set, NULL,
+							fold1, fold2);
+}
+
 __isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_add_qpolynomial(
 	__isl_take isl_qpolynomial_fold *fold, __isl_take isl_qpolynomial *qp)
 {
@@ -1197,7 +1251,7 @@ static int qpolynomial_fold_covers_on_domain(__isl_keep isl_set *set,
 			d = isl_qpolynomial_sub(
 				isl_qpolynomial_copy(fold1->qp[j]),
 				isl_qpolynomial_copy(fold2->qp[i]));
-			sgn = isl_qpolynomial_sign(set, d);
+			sgn = isl_qpolynomial_sign(set, NULL, d);
 			isl_qpolynomial_free(d);
 			if (sgn == covers)
 				break;
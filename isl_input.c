@@ -542,16 +542,64 @@ error2:
 	return NULL;
 }
 
-static __isl_give isl_pw_aff *add_cst(__isl_take isl_pw_aff *pwaff, isl_int v)
+/* Is "pa" a piecewise affine expression with a single piece
+ * defined over a universe domain and without any integer divisions?
+ * Such an expression can be converted into a constraint directly.
+ */
+static isl_bool pw_aff_is_plain_aff(__isl_keep isl_pw_aff *pa)
 {
-	isl_aff *aff;
-	isl_space *space;
+	isl_bool universe;
 
-	space = isl_pw_aff_get_domain_space(pwaff);
-	aff = isl_aff_zero_on_domain(isl_local_space_from_space(space));
-	aff = isl_aff_add_constant(aff, v);
+	if (!pa)
+		return isl_bool_error;
+	if (pa->n != 1)
+		return isl_bool_false;
+	if (isl_aff_is_nan(pa->p[0].aff) ||
+	    isl_aff_dim(pa->p[0].aff, isl_dim_div) != 0)
+		return isl_bool_false;
+	universe = isl_set_plain_is_universe(pa->p[0].set);
+	if (universe < 0 || !universe)
+		return universe;
+	return isl_bool_true;
+}
+
+/* Add "term", multiplied by "sign", to the affine expression
+ * being constructed by accept_affine.
+ * This affine expression is the sum of the plain affine expression "*aff"
+ * and the piecewise affine expression "*res", if any.
+ *
+ * If "term" is a plain affine expression, then it is added to "*aff",
+ * which avoids the relatively expensive operations
+ * on piecewise affine expressions.
+ */
+static isl_stat add_term(__isl_keep isl_aff **aff, __isl_keep isl_pw_aff **res,
+	__isl_take isl_pw_aff *term, int sign)
+{
+	isl_bool plain;
+
+	plain = pw_aff_is_plain_aff(term);
+	if (plain < 0) {
+		isl_pw_aff_free(term);
+		return isl_stat_error;
+	}
+	if (plain) {
+		isl_aff *t = isl_aff_copy(term->p[0].aff);
+
+		isl_pw_aff_free(term);
+		if (sign < 0)
+			*aff = isl_aff_sub(*aff, t);
+		else
+			*aff = isl_aff_add(*aff, t);
+		return *aff ? isl_stat_ok : isl_stat_error;
+	}
 
-	return isl_pw_aff_add(pwaff, isl_pw_aff_from_aff(aff));
+	if (sign < 0)
+		term = isl_pw_aff_neg(term);
+	if (*res)
+		*res = isl_pw_aff_add(*res, term);
+	else
+		*res = term;
+	return *res ? isl_stat_ok : isl_stat_error;
 }
 
 /* Return a piecewise affine expression defined on the specified domain
@@ -565,17 +613,24 @@ static __isl_give isl_pw_aff *nan_on_domain(__isl_keep isl_space *space)
 	return isl_pw_aff_nan_on_domain(ls);
 }
 
+/* Read an affine expression from "s".
+ *
+ * The plain affine terms are accumulated in "aff", while
+ * the other terms are accumulated in "res".
+ * The two are only combined at the end.
+ */
 static __isl_give isl_pw_aff *accept_affine(__isl_keep isl_stream *s,
 	__isl_take isl_space *space, struct vars *v)
 {
 	struct isl_token *tok = NULL;
 	isl_local_space *ls;
-	isl_pw_aff *res;
+	isl_aff *aff;
+	isl_pw_aff *res = NULL;
 	int sign = 1;
 
 	ls = isl_local_space_from_space(isl_space_copy(space));
-	res = isl_pw_aff_from_aff(isl_aff_zero_on_domain(ls));
-	if (!res)
+	aff = isl_aff_zero_on_domain(ls);
+	if (!aff)
 		goto error;
 
 	for (;;) {
@@ -598,11 +653,7 @@ static __isl_give isl_pw_aff *accept_affine(__isl_keep isl_stream *s,
 			tok = NULL;
 			term = accept_affine_factor(s,
 						    isl_space_copy(space), v);
-			if (sign < 0)
-				res = isl_pw_aff_sub(res, term);
-			else
-				res = isl_pw_aff_add(res, term);
-			if (!res)
+			if (add_term(&aff, &res, term, sign) < 0)
 				goto error;
 			sign = 1;
 		} else if (tok->type == ISL_TOKEN_VALUE) {
@@ -614,18 +665,21 @@ static __isl_give isl_pw_aff *accept_affine(__isl_keep isl_stream *s,
 				term = accept_affine_factor(s,
 						    isl_space_copy(space), v);
 				term = isl_pw_aff_scale(term, tok->u.v);
-				res = isl_pw_aff_add(res, term);
-				if (!res)
+				if (add_term(&aff, &res, term, 1) < 0)
 					goto error;
 			} else {
-				res = add_cst(res, tok->u.v);
+				aff = isl_aff_add_constant(aff, tok->u.v);
+				if (!aff)
+					goto error;
 			}
 			sign = 1;
 		} else if (tok->type == ISL_TOKEN_NAN) {
-			res = isl_pw_aff_add(res, nan_on_domain(space));
+			if (add_term(&aff, &res, nan_on_domain(space), 1) < 0)
+				goto error;
 		} else {
 			isl_stream_error(s, tok, "unexpected isl_token");
 			isl_stream_push_token(s, tok);
+			isl_aff_free(aff);
 			isl_pw_aff_free(res);
 			isl_space_free(space);
 			return NULL;
@@ -650,10 +704,17 @@ static __isl_give isl_pw_aff *accept_affine(__isl_keep isl_stream *s,
 	}
 
 	isl_space_free(space);
-	return res;
+	if (!res)
+		return isl_pw_aff_from_aff(aff);
+	if (isl_aff_plain_is_zero(aff)) {
+		isl_aff_free(aff);
+		return res;
+	}
+	return isl_pw_aff_add(res, isl_pw_aff_from_aff(aff));
 error:
 	isl_space_free(space);
 	isl_token_free(tok);
+	isl_aff_free(aff);
 	isl_pw_aff_free(res);
 	return NULL;
 }
@@ -1505,6 +1566,128 @@ error:
 	return NULL;
 }
 
+/* Are all elements of "list" plain affine expressions
+ * in the sense of pw_aff_is_plain_aff?
+ */
+static isl_bool pw_aff_list_is_plain(__isl_keep isl_pw_aff_list *list)
+{
+	int i, n;
+
+	n = isl_pw_aff_list_n_pw_aff(list);
+	if (n < 0)
+		return isl_bool_error;
+	for (i = 0; i < n; ++i) {
+		isl_bool plain;
+
+		plain = pw_aff_is_plain_aff(list->p[i]);
+		if (plain < 0 || !plain)
+			return plain;
+	}
+
+	return isl_bool_true;
+}
+
+/* Can the constraints "left op right", with op of type "type",
+ * be constructed by construct_plain_constraints?
+ * That is, is "type" a comparison operator between individual
+ * affine expressions other than "!=" and are all elements
+ * of "left" and "right" plain affine expressions?
+ * Rational constraints are left to the generic code.
+ */
+static isl_bool is_plain_constraint(int type,
+	__isl_keep isl_pw_aff_list *left, __isl_keep isl_pw_aff_list *right,
+	int rational)
+{
+	isl_bool plain;
+
+	if (rational)
+		return isl_bool_false;
+	if (type != ISL_TOKEN_LE && type != ISL_TOKEN_GE &&
+	    type != ISL_TOKEN_LT && type != ISL_TOKEN_GT && type != '=')
+		return isl_bool_false;
+	plain = pw_aff_list_is_plain(left);
+	if (plain < 0 || !plain)
+		return plain;
+	return pw_aff_list_is_plain(right);
+}
+
+/* Construct constraints of the form
+ *
+ *	a op b
+ *
+ * where a is an element in "left", op is an operator of type "type" and
+ * b is an element in "right", add the constraints to "set" and return
+ * the result, where all elements of "left" and "right" are known
+ * to be plain affine expressions and "type" is known not to be
+ * a list comparator or "!=".
+ *
+ * Since none of the affine expressions is piecewise or
+ * involves any integer divisions, the constraints can be written
+ * directly into a single basic set, bypassing the computations
+ * on piecewise affine expressions performed by construct_constraints.
+ * The constraints are the same as those constructed
+ * by isl_pw_aff_list_le_set and friends.
+ * If "set" itself consists of a single basic set without
+ * integer divisions, then the constraints are added to this basic set
+ * directly, as in map_intersect_add_constraint.
+ * Otherwise, they are collected in a separate basic set that
+ * is intersected with "set".
+ */
+static __isl_give isl_set *construct_plain_constraints(
+	__isl_take isl_set *set, int type,
+	__isl_keep isl_pw_aff_list *left, __isl_keep isl_pw_aff_list *right)
+{
+	int i, j, n1, n2;
+	int convex;
+	isl_basic_set *bset;
+
+	if (!set)
+		return NULL;
+
+	n1 = isl_pw_aff_list_n_pw_aff(left);
+	n2 = isl_pw_aff_list_n_pw_aff(right);
+	convex = set->n == 1 && set->p[0]->n_div == 0;
+	if (convex) {
+		bset = isl_basic_set_copy(set->p[0]);
+		isl_set_free(set);
+		bset = isl_basic_set_cow(bset);
+	} else {
+		bset = isl_basic_set_universe(isl_set_get_space(set));
+	}
+	if (type == '=')
+		bset = isl_basic_set_extend_constraints(bset, n1 * n2, 0);
+	else
+		bset = isl_basic_set_extend_constraints(bset, 0, n1 * n2);
+	for (i = 0; i < n1; ++i) {
+		for (j = 0; j < n2; ++j) {
+			isl_aff *aff;
+
+			aff = isl_aff_copy(left->p[i]->p[0].aff);
+			aff = isl_aff_sub(aff,
+					isl_aff_copy(right->p[j]->p[0].aff));
+			if (type == ISL_TOKEN_LE || type == ISL_TOKEN_LT)
+				aff = isl_aff_neg(aff);
+			if (type == ISL_TOKEN_LT || type == ISL_TOKEN_GT)
+				aff = isl_aff_add_constant_si(aff, -1);
+			if (!aff)
+				bset = isl_basic_set_free(bset);
+			else if (type == '=')
+				bset = isl_basic_set_add_eq(bset,
+							    aff->v->el + 1);
+			else
+				bset = isl_basic_set_add_ineq(bset,
+							    aff->v->el + 1);
+			isl_aff_free(aff);
+		}
+	}
+	bset = isl_basic_set_simplify(bset);
+	bset = isl_basic_set_finalize(bset);
+
+	if (convex)
+		return isl_set_from_basic_set(bset);
+	return isl_set_intersect(set, isl_set_from_basic_set(bset));
+}
+
 /* Construct constraints of the form
  *
  *	a op b
@@ -1518,6 +1701,8 @@ error:
  * If "type" is the type of a comparison operator between lists
  * of affine expressions, then a single (compound) constraint
  * is constructed by list_cmp instead.
+ * If all affine expressions are plain, then the constraints
+ * are constructed directly by construct_plain_constraints.
  */
 static __isl_give isl_set *construct_constraints(
 	__isl_take isl_set *set, int type,
@@ -1525,6 +1710,13 @@ static __isl_give isl_set *construct_constraints(
 	int rational)
 {
 	isl_set *cond;
+	isl_bool plain;
+
+	plain = is_plain_constraint(type, left, right, rational);
+	if (plain < 0)
+		return isl_set_free(set);
+	if (plain)
+		return construct_plain_constraints(set, type, left, right);
 
 	left = isl_pw_aff_list_copy(left);
 	right = isl_pw_aff_list_copy(right);
@@ -1774,6 +1966,16 @@ error:
 	return NULL;
 }
 
+/* Read a conjunction of (possibly negated) conjuncts from "s" and
+ * intersect "map" with the result.
+ *
+ * Since each conjunct read by read_conjunct is intersected with
+ * the map that is passed to it, a non-negated conjunct
+ * is read directly on top of the result of the previous conjuncts.
+ * This allows simple constraints to be added directly to this result
+ * rather than first constructing a separate map and then intersecting
+ * it with the result.
+ */
 static __isl_give isl_map *read_conjuncts(__isl_keep isl_stream *s,
 	struct vars *v, __isl_take isl_map *map, int rational)
 {
@@ -1789,11 +1991,12 @@ static __isl_give isl_map *read_conjuncts(__isl_keep isl_stream *s,
 		isl_map *res_i;
 
 		negate = isl_stream_eat_if_available(s, ISL_TOKEN_NOT);
+		if (!negate) {
+			res = read_conjunct(s, v, res, rational);
+			continue;
+		}
 		res_i = read_conjunct(s, v, isl_map_copy(map), rational);
-		if (negate)
-			res = isl_map_subtract(res, res_i);
-		else
-			res = isl_map_intersect(res, res_i);
+		res = isl_map_subtract(res, res_i);
 	}
 
 	isl_map_free(map);
@@ -2458,9 +2661,23 @@ error:
 	return obj;
 }
 
+/* Combine "obj1" and "obj2" into a single object.
+ *
+ * A map or set that is added to a union map or union set is
+ * inserted directly, rather than first being converted
+ * into a union map or union set of its own.
+ */
 static struct isl_obj obj_add(__isl_keep isl_stream *s,
 	struct isl_obj obj1, struct isl_obj obj2)
 {
+	if (obj1.type == isl_obj_union_map && obj2.type == isl_obj_map) {
+		obj1.v = isl_union_map_add_map(obj1.v, obj2.v);
+		return obj1;
+	}
+	if (obj1.type == isl_obj_union_set && obj2.type == isl_obj_set) {
+		obj1.v = isl_union_set_add_set(obj1.v, obj2.v);
+		return obj1;
+	}
 	if (obj1.type == isl_obj_set && obj2.type == isl_obj_union_set)
 		obj1 = to_union(s->ctx, obj1);
 	if (obj1.type == isl_obj_union_set && obj2.type == isl_obj_set)
@@ -629,6 +629,8 @@ __isl_give isl_basic_map *isl_basic_map_sort_divs(
 		for (j = i - 1; j >= 0; --j) {
 			if (bmap_cmp_row(bmap, j, j + 1, total) <= 0)
 				break;
+			if (isl_basic_map_own_constraints(bmap) < 0)
+				return isl_basic_map_free(bmap);
 			isl_basic_map_swap_div(bmap, j, j + 1);
 		}
 	}
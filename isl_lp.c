@@ -10,6 +10,7 @@
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl/lp.h>
+#include <isl_lp_private.h>
 #include <isl_seq.h>
 #include "isl_tab.h"
 #include <isl_options_private.h>
@@ -364,3 +365,363 @@ __isl_give isl_val *isl_basic_set_max_lp_val(__isl_keep isl_basic_set *bset,
 {
 	return isl_basic_set_opt_lp_val(bset, 1, obj);
 }
+
+/* Free "box" and return NULL.
+ */
+struct isl_set_box *isl_set_box_free(struct isl_set_box *box)
+{
+	if (!box)
+		return NULL;
+	free(box->has_lo);
+	free(box->has_hi);
+	isl_vec_free(box->lo);
+	isl_vec_free(box->hi);
+	free(box);
+	return NULL;
+}
+
+/* Allocate a box for "n" variables, without any bounds.
+ */
+static struct isl_set_box *isl_set_box_alloc(isl_ctx *ctx, unsigned n)
+{
+	struct isl_set_box *box;
+
+	box = isl_calloc_type(ctx, struct isl_set_box);
+	if (!box)
+		return NULL;
+	box->has_lo = isl_calloc_array(ctx, char, n);
+	box->has_hi = isl_calloc_array(ctx, char, n);
+	box->lo = isl_vec_alloc(ctx, n);
+	box->hi = isl_vec_alloc(ctx, n);
+	if ((n && (!box->has_lo || !box->has_hi)) || !box->lo || !box->hi)
+		return isl_set_box_free(box);
+	return box;
+}
+
+/* Compute the minimal value of "f" over "tab" and store it in "v".
+ * If "integral" is set, then "tab" represents an integer set
+ * and the minimal value is rounded up.  Otherwise, it is rounded down.
+ * Return isl_bool_true if a minimal value was found and
+ * isl_bool_false if "f" is unbounded from below.
+ * "tab" is assumed not to be empty.
+ */
+static isl_bool tab_min_bound(struct isl_tab *tab, isl_int *f, int integral,
+	isl_int *v, isl_int *denom)
+{
+	enum isl_lp_result res;
+
+	if (integral)
+		res = isl_tab_min(tab, f, tab->mat->ctx->one, v, NULL, 0);
+	else
+		res = isl_tab_min(tab, f, tab->mat->ctx->one, v, denom, 0);
+	if (res == isl_lp_error)
+		return isl_bool_error;
+	if (res != isl_lp_ok)
+		return isl_bool_false;
+	if (!integral)
+		isl_int_fdiv_q(*v, *v, *denom);
+	return isl_bool_true;
+}
+
+/* Extend the bounds in "box" to include the elements of "bmap".
+ * If "box" is still marked empty, then it is simply replaced
+ * by the bounds of "bmap".
+ *
+ * The bounds are computed from the rational relaxation of "bmap".
+ * If "bmap" is an integer basic map, then they are rounded inwards,
+ * while they are rounded outwards if it is rational.
+ * The upper bound on a variable is computed as minus the minimal
+ * value of its negation.
+ */
+static isl_stat isl_set_box_add_basic_map(struct isl_set_box *box,
+	__isl_keep isl_basic_map *bmap)
+{
+	int k;
+	int integral;
+	unsigned total, n;
+	isl_ctx *ctx;
+	isl_vec *f;
+	isl_int v, d;
+	struct isl_tab *tab;
+	isl_stat r = isl_stat_ok;
+
+	ctx = isl_basic_map_get_ctx(bmap);
+	tab = isl_tab_from_basic_map(bmap, 0);
+	if (!tab)
+		return isl_stat_error;
+	if (tab->empty) {
+		isl_tab_free(tab);
+		return isl_stat_ok;
+	}
+
+	integral = !ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL);
+	n = isl_basic_map_dim(bmap, isl_dim_all) -
+		isl_basic_map_dim(bmap, isl_dim_div);
+	total = isl_basic_map_total_dim(bmap);
+	f = isl_vec_alloc(ctx, 1 + total);
+	if (!f) {
+		isl_tab_free(tab);
+		return isl_stat_error;
+	}
+	isl_seq_clr(f->el, 1 + total);
+	isl_int_init(v);
+	isl_int_init(d);
+	for (k = 0; k < n; ++k) {
+		isl_bool bounded;
+
+		isl_int_set_si(f->el[1 + k], 1);
+		bounded = tab_min_bound(tab, f->el, integral, &v, &d);
+		if (bounded < 0)
+			r = isl_stat_error;
+		if (bounded < 0)
+			break;
+		if (!bounded)
+			box->has_lo[k] = 0;
+		else if (box->empty || isl_int_lt(v, box->lo->el[k]))
+			isl_int_set(box->lo->el[k], v);
+		if (box->empty)
+			box->has_lo[k] = bounded;
+
+		isl_int_set_si(f->el[1 + k], -1);
+		bounded = tab_min_bound(tab, f->el, integral, &v, &d);
+		isl_int_set_si(f->el[1 + k], 0);
+		if (bounded < 0)
+			r = isl_stat_error;
+		if (bounded < 0)
+			break;
+		isl_int_neg(v, v);
+		if (!bounded)
+			box->has_hi[k] = 0;
+		else if (box->empty || isl_int_gt(v, box->hi->el[k]))
+			isl_int_set(box->hi->el[k], v);
+		if (box->empty)
+			box->has_hi[k] = bounded;
+	}
+	box->empty = 0;
+	isl_int_clear(d);
+	isl_int_clear(v);
+	isl_vec_free(f);
+	isl_tab_free(tab);
+
+	return r;
+}
+
+/* Compute bounds on the parameters and set variables of "set"
+ * that hold for all elements of "set".
+ */
+struct isl_set_box *isl_set_box_compute(__isl_keep isl_set *set)
+{
+	int i;
+	struct isl_set_box *box;
+
+	if (!set)
+		return NULL;
+
+	box = isl_set_box_alloc(isl_set_get_ctx(set),
+				isl_set_dim(set, isl_dim_all));
+	if (!box)
+		return NULL;
+	box->empty = 1;
+	for (i = 0; i < set->n; ++i)
+		if (isl_set_box_add_basic_map(box, set->p[i]) < 0)
+			return isl_set_box_free(box);
+
+	return box;
+}
+
+/* Compute bounds on the parameters and variables of the integer
+ * basic map "bmap" without integer divisions from those
+ * of its constraints that involve a single variable.
+ * The bounds are exact if all constraints of "bmap" are of this form.
+ * In particular, "box" is then marked empty if and only if
+ * "bmap" has no integer points.
+ *
+ * A constraint a x + c >= 0 with a > 0 results in the lower bound
+ * x >= ceil(-c/a), while a constraint with a < 0 results in
+ * the upper bound x <= floor(c/-a).
+ * An equality a x + c = 0 fixes x to -c/a, if this value is integral.
+ */
+struct isl_set_box *isl_basic_map_plain_box(__isl_keep isl_basic_map *bmap)
+{
+	int i, k;
+	unsigned total;
+	struct isl_set_box *box;
+	isl_int v;
+
+	if (!bmap)
+		return NULL;
+	if (bmap->n_div != 0)
+		isl_die(isl_basic_map_get_ctx(bmap), isl_error_invalid,
+			"unexpected integer divisions", return NULL);
+
+	total = isl_basic_map_total_dim(bmap);
+	box = isl_set_box_alloc(isl_basic_map_get_ctx(bmap), total);
+	if (!box)
+		return NULL;
+	box->empty = ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY);
+
+	isl_int_init(v);
+	for (i = 0; !box->empty && i < bmap->n_eq; ++i) {
+		isl_int *c = bmap->eq[i];
+
+		k = isl_seq_first_non_zero(c + 1, total);
+		if (k < 0) {
+			box->empty = !isl_int_is_zero(c[0]);
+			continue;
+		}
+		if (isl_seq_first_non_zero(c + 1 + k + 1, total - k - 1) >= 0)
+			continue;
+		if (!isl_int_is_divisible_by(c[0], c[1 + k])) {
+			box->empty = 1;
+			continue;
+		}
+		isl_int_divexact(v, c[0], c[1 + k]);
+		isl_int_neg(v, v);
+		if (!box->has_lo[k] || isl_int_gt(v, box->lo->el[k]))
+			isl_int_set(box->lo->el[k], v);
+		if (!box->has_hi[k] || isl_int_lt(v, box->hi->el[k]))
+			isl_int_set(box->hi->el[k], v);
+		box->has_lo[k] = box->has_hi[k] = 1;
+	}
+	for (i = 0; !box->empty && i < bmap->n_ineq; ++i) {
+		isl_int *c = bmap->ineq[i];
+
+		k = isl_seq_first_non_zero(c + 1, total);
+		if (k < 0) {
+			box->empty = isl_int_is_neg(c[0]);
+			continue;
+		}
+		if (isl_seq_first_non_zero(c + 1 + k + 1, total - k - 1) >= 0)
+			continue;
+		if (isl_int_is_pos(c[1 + k])) {
+			isl_int_neg(v, c[0]);
+			isl_int_cdiv_q(v, v, c[1 + k]);
+			if (!box->has_lo[k] || isl_int_gt(v, box->lo->el[k]))
+				isl_int_set(box->lo->el[k], v);
+			box->has_lo[k] = 1;
+		} else {
+			isl_int_neg(v, c[1 + k]);
+			isl_int_fdiv_q(v, c[0], v);
+			if (!box->has_hi[k] || isl_int_lt(v, box->hi->el[k]))
+				isl_int_set(box->hi->el[k], v);
+			box->has_hi[k] = 1;
+		}
+	}
+	isl_int_clear(v);
+
+	for (k = 0; !box->empty && k < total; ++k)
+		if (box->has_lo[k] && box->has_hi[k] &&
+		    isl_int_gt(box->lo->el[k], box->hi->el[k]))
+			box->empty = 1;
+
+	return box;
+}
+
+/* Compute the minimal value of the affine expression "c"
+ * over the non-empty box "box" and store it in "v".
+ * Return isl_bool_false if "c" is unbounded from below over "box".
+ * Since the box is defined by integer bounds on the individual variables,
+ * the minimum is attained at an integer point.
+ */
+static isl_bool box_min(struct isl_set_box *box, isl_int *c, isl_int *v)
+{
+	int k;
+
+	isl_int_set(*v, c[0]);
+	for (k = 0; k < box->lo->size; ++k) {
+		if (isl_int_is_zero(c[1 + k]))
+			continue;
+		if (isl_int_is_pos(c[1 + k])) {
+			if (!box->has_lo[k])
+				return isl_bool_false;
+			isl_int_addmul(*v, c[1 + k], box->lo->el[k]);
+		} else {
+			if (!box->has_hi[k])
+				return isl_bool_false;
+			isl_int_addmul(*v, c[1 + k], box->hi->el[k]);
+		}
+	}
+
+	return isl_bool_true;
+}
+
+/* Is the box "box" of integer points a subset of "bmap",
+ * which lives in the same space and does not have any integer divisions?
+ * That is, is the minimum of each constraint of "bmap" over "box"
+ * non-negative and, for the equality constraints, also the minimum
+ * of the negated constraint?
+ */
+isl_bool isl_set_box_is_subset(struct isl_set_box *box,
+	__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	unsigned total;
+	isl_bool subset = isl_bool_true;
+	isl_vec *c;
+	isl_int v;
+
+	if (!box || !bmap)
+		return isl_bool_error;
+	if (box->empty)
+		return isl_bool_true;
+	if (bmap->n_div != 0)
+		isl_die(isl_basic_map_get_ctx(bmap), isl_error_invalid,
+			"unexpected integer divisions", return isl_bool_error);
+	total = isl_basic_map_total_dim(bmap);
+	if (total != box->lo->size)
+		isl_die(isl_basic_map_get_ctx(bmap), isl_error_invalid,
+			"dimension mismatch", return isl_bool_error);
+
+	c = isl_vec_alloc(isl_basic_map_get_ctx(bmap), 1 + total);
+	if (!c)
+		return isl_bool_error;
+	isl_int_init(v);
+	for (i = 0; subset == isl_bool_true && i < bmap->n_eq; ++i) {
+		subset = box_min(box, bmap->eq[i], &v);
+		if (subset == isl_bool_true && isl_int_is_neg(v))
+			subset = isl_bool_false;
+		if (subset != isl_bool_true)
+			break;
+		isl_seq_neg(c->el, bmap->eq[i], 1 + total);
+		subset = box_min(box, c->el, &v);
+		if (subset == isl_bool_true && isl_int_is_neg(v))
+			subset = isl_bool_false;
+	}
+	for (i = 0; subset == isl_bool_true && i < bmap->n_ineq; ++i) {
+		subset = box_min(box, bmap->ineq[i], &v);
+		if (subset == isl_bool_true && isl_int_is_neg(v))
+			subset = isl_bool_false;
+	}
+	isl_int_clear(v);
+	isl_vec_free(c);
+
+	return subset;
+}
+
+/* Are the sets with bounds "box1" and "box2" known to be disjoint?
+ * That is, is either of them empty or is there a variable
+ * for which the ranges of values allowed by "box1" and "box2"
+ * do not overlap?
+ */
+isl_bool isl_set_box_is_disjoint(struct isl_set_box *box1,
+	struct isl_set_box *box2)
+{
+	int k;
+
+	if (!box1 || !box2)
+		return isl_bool_error;
+	if (box1->empty || box2->empty)
+		return isl_bool_true;
+	if (box1->lo->size != box2->lo->size)
+		return isl_bool_false;
+	for (k = 0; k < box1->lo->size; ++k) {
+		if (box1->has_lo[k] && box2->has_hi[k] &&
+		    isl_int_gt(box1->lo->el[k], box2->hi->el[k]))
+			return isl_bool_true;
+		if (box2->has_lo[k] && box1->has_hi[k] &&
+		    isl_int_gt(box2->lo->el[k], box1->hi->el[k]))
+			return isl_bool_true;
+	}
+
+	return isl_bool_false;
+}
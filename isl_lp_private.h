@@ -18,4 +18,26 @@ enum isl_lp_result isl_set_solve_lp(__isl_keep isl_set *set, int max,
 	isl_int *f, isl_int denom, isl_int *opt, isl_int *opt_denom,
 	__isl_give isl_vec **sol);
 
+/* Bounds on the variables (parameters and set variables) of a set.
+ * "empty" is set if the set is known to be empty.
+ * Otherwise, if has_lo[k] is set, then lo->el[k] is a lower bound
+ * on variable k and if has_hi[k] is set, then hi->el[k] is
+ * an upper bound on variable k.
+ */
+struct isl_set_box {
+	int empty;
+	char *has_lo;
+	char *has_hi;
+	isl_vec *lo;
+	isl_vec *hi;
+};
+
+struct isl_set_box *isl_set_box_compute(__isl_keep isl_set *set);
+struct isl_set_box *isl_basic_map_plain_box(__isl_keep isl_basic_map *bmap);
+struct isl_set_box *isl_set_box_free(struct isl_set_box *box);
+isl_bool isl_set_box_is_disjoint(struct isl_set_box *box1,
+	struct isl_set_box *box2);
+isl_bool isl_set_box_is_subset(struct isl_set_box *box,
+	__isl_keep isl_basic_map *bmap);
+
 #endif
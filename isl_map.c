@@ -506,7 +506,7 @@ __isl_give isl_space *isl_set_get_space(__isl_keep isl_set *set)
 __isl_give isl_basic_map *isl_basic_map_set_tuple_name(
 	__isl_take isl_basic_map *bmap, enum isl_dim_type type, const char *s)
 {
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 	bmap->dim = isl_space_set_tuple_name(bmap->dim, type, s);
@@ -562,7 +562,7 @@ __isl_give isl_basic_map *isl_basic_map_set_tuple_id(
 	__isl_take isl_basic_map *bmap,
 	enum isl_dim_type type, __isl_take isl_id *id)
 {
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		goto error;
 	bmap->dim = isl_space_set_tuple_id(bmap->dim, type, id);
@@ -730,7 +730,7 @@ __isl_give isl_basic_map *isl_basic_map_set_dim_name(
 	__isl_take isl_basic_map *bmap,
 	enum isl_dim_type type, unsigned pos, const char *s)
 {
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 	bmap->dim = isl_space_set_dim_name(bmap->dim, type, pos, s);
@@ -1320,9 +1320,12 @@ __isl_null isl_basic_map *isl_basic_map_free(__isl_take isl_basic_map *bmap)
 
 	isl_ctx_deref(bmap->ctx);
 	free(bmap->div);
-	isl_blk_free(bmap->ctx, bmap->block2);
 	free(bmap->ineq);
-	isl_blk_free(bmap->ctx, bmap->block);
+	if (!bmap->block_ref || --*bmap->block_ref == 0) {
+		isl_blk_free(bmap->ctx, bmap->block2);
+		isl_blk_free(bmap->ctx, bmap->block);
+		free(bmap->block_ref);
+	}
 	isl_vec_free(bmap->sample);
 	isl_space_free(bmap->dim);
 	free(bmap);
@@ -1414,7 +1417,7 @@ isl_bool isl_map_align_params_map_map_and_test(__isl_keep isl_map *map1,
 int isl_basic_map_alloc_equality(struct isl_basic_map *bmap)
 {
 	struct isl_ctx *ctx;
-	if (!bmap)
+	if (isl_basic_map_own_constraints(bmap) < 0)
 		return -1;
 	ctx = bmap->ctx;
 	isl_assert(ctx, room_for_con(bmap, 1), return -1);
@@ -1512,7 +1515,7 @@ static int room_for_ineq(struct isl_basic_map *bmap, unsigned n)
 int isl_basic_map_alloc_inequality(__isl_keep isl_basic_map *bmap)
 {
 	struct isl_ctx *ctx;
-	if (!bmap)
+	if (isl_basic_map_own_constraints(bmap) < 0)
 		return -1;
 	ctx = bmap->ctx;
 	isl_assert(ctx, room_for_ineq(bmap, 1), return -1);
@@ -1617,7 +1620,7 @@ __isl_give isl_basic_set *isl_basic_set_add_ineq(__isl_take isl_basic_set *bset,
 
 int isl_basic_map_alloc_div(struct isl_basic_map *bmap)
 {
-	if (!bmap)
+	if (isl_basic_map_own_constraints(bmap) < 0)
 		return -1;
 	isl_assert(bmap->ctx, bmap->n_div < bmap->extra, return -1);
 	isl_seq_clr(bmap->div[bmap->n_div] +
@@ -1910,6 +1913,122 @@ __isl_give isl_basic_set *isl_basic_set_cow(__isl_take isl_basic_set *bset)
 	return bset_from_bmap(isl_basic_map_cow(bset_to_bmap(bset)));
 }
 
+/* Make sure the constraints and integer divisions of "bmap"
+ * are not shared with any other basic map, such that they can be
+ * modified in place.
+ * If they are shared, then "bmap" is given its own copy of
+ * the blocks holding them.
+ * Note that the blocks may also contain unused constraints that
+ * are kept around for later reuse, so the entire blocks are copied
+ * and the row pointers are moved to the corresponding positions
+ * in the new blocks.
+ */
+isl_stat isl_basic_map_own_constraints(__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	struct isl_blk block, block2;
+
+	if (!bmap)
+		return isl_stat_error;
+	if (!bmap->block_ref)
+		return isl_stat_ok;
+	if (*bmap->block_ref == 1) {
+		free(bmap->block_ref);
+		bmap->block_ref = NULL;
+		return isl_stat_ok;
+	}
+
+	block = isl_blk_alloc(bmap->ctx, bmap->block.size);
+	if (isl_blk_is_error(block))
+		return isl_stat_error;
+	block2 = isl_blk_empty();
+	if (bmap->block2.size > 0) {
+		block2 = isl_blk_alloc(bmap->ctx, bmap->block2.size);
+		if (isl_blk_is_error(block2)) {
+			isl_blk_free(bmap->ctx, block);
+			return isl_stat_error;
+		}
+	}
+	isl_seq_cpy(block.data, bmap->block.data, bmap->block.size);
+	isl_seq_cpy(block2.data, bmap->block2.data, bmap->block2.size);
+	for (i = 0; i < bmap->c_size; ++i)
+		bmap->ineq[i] = block.data + (bmap->ineq[i] - bmap->block.data);
+	for (i = 0; i < bmap->extra; ++i)
+		bmap->div[i] = block2.data + (bmap->div[i] - bmap->block2.data);
+	bmap->eq = bmap->ineq + (bmap->eq - bmap->ineq);
+
+	--*bmap->block_ref;
+	bmap->block_ref = NULL;
+	bmap->block = block;
+	bmap->block2 = block2;
+
+	return isl_stat_ok;
+}
+
+/* Return a copy of "bmap" that shares the blocks holding
+ * the constraints and the integer divisions with "bmap".
+ * The arrays of pointers to the constraints and integer divisions
+ * are copied since their order may be changed without
+ * modifying the constraints themselves.
+ */
+static __isl_give isl_basic_map *dup_sharing_constraints(
+	__isl_keep isl_basic_map *bmap)
+{
+	isl_ctx *ctx;
+	struct isl_basic_map *dup;
+
+	if (!bmap)
+		return NULL;
+
+	ctx = isl_basic_map_get_ctx(bmap);
+	if (!bmap->block_ref) {
+		bmap->block_ref = isl_alloc_type(ctx, int);
+		if (!bmap->block_ref)
+			return NULL;
+		*bmap->block_ref = 1;
+	}
+
+	dup = isl_calloc_type(ctx, struct isl_basic_map);
+	if (!dup)
+		return NULL;
+
+	dup->ctx = ctx;
+	isl_ctx_ref(ctx);
+	dup->ref = 1;
+	dup->block = bmap->block;
+	dup->block2 = bmap->block2;
+	dup->block_ref = bmap->block_ref;
+	++*dup->block_ref;
+
+	dup->flags = bmap->flags;
+	dup->dim = isl_space_copy(bmap->dim);
+	dup->extra = bmap->extra;
+	dup->c_size = bmap->c_size;
+	dup->n_eq = bmap->n_eq;
+	dup->n_ineq = bmap->n_ineq;
+	dup->n_div = bmap->n_div;
+	dup->sample = isl_vec_copy(bmap->sample);
+
+	dup->ineq = isl_alloc_array(ctx, isl_int *, bmap->c_size);
+	if (bmap->c_size && !dup->ineq)
+		return isl_basic_map_free(dup);
+	if (bmap->c_size)
+		memcpy(dup->ineq, bmap->ineq, bmap->c_size * sizeof(isl_int *));
+	dup->eq = dup->ineq + (bmap->eq - bmap->ineq);
+
+	if (bmap->extra) {
+		dup->div = isl_alloc_array(ctx, isl_int *, bmap->extra);
+		if (!dup->div)
+			return isl_basic_map_free(dup);
+		memcpy(dup->div, bmap->div, bmap->extra * sizeof(isl_int *));
+	}
+
+	if (!dup->dim)
+		return isl_basic_map_free(dup);
+
+	return dup;
+}
+
 __isl_give isl_basic_map *isl_basic_map_cow(__isl_take isl_basic_map *bmap)
 {
 	if (!bmap)
@@ -1919,6 +2038,34 @@ __isl_give isl_basic_map *isl_basic_map_cow(__isl_take isl_basic_map *bmap)
 		bmap->ref--;
 		bmap = isl_basic_map_dup(bmap);
 	}
+	if (isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
+	if (bmap) {
+		ISL_F_CLR(bmap, ISL_BASIC_SET_FINAL);
+		ISL_F_CLR(bmap, ISL_BASIC_MAP_REDUCED_COEFFICIENTS);
+	}
+	return bmap;
+}
+
+/* Return a version of "bmap" that can be modified in its space and
+ * in its flags, but not (yet) in its constraints or integer divisions.
+ * If "bmap" is shared, then the result shares the blocks holding
+ * the constraints and integer divisions with "bmap".
+ * These blocks are only copied if the constraints or
+ * integer divisions of either of the two basic maps get modified.
+ * This avoids copying the constraints of basic maps that only
+ * differ in the identifiers or names in their spaces.
+ */
+__isl_give isl_basic_map *isl_basic_map_cow_space(
+	__isl_take isl_basic_map *bmap)
+{
+	if (!bmap)
+		return NULL;
+
+	if (bmap->ref > 1) {
+		bmap->ref--;
+		bmap = dup_sharing_constraints(bmap);
+	}
 	if (bmap) {
 		ISL_F_CLR(bmap, ISL_BASIC_SET_FINAL);
 		ISL_F_CLR(bmap, ISL_BASIC_MAP_REDUCED_COEFFICIENTS);
@@ -2024,7 +2171,7 @@ __isl_give isl_basic_map *isl_basic_map_set_to_empty(
 {
 	int i = 0;
 	unsigned total;
-	if (!bmap)
+	if (isl_basic_map_own_constraints(bmap) < 0)
 		goto error;
 	total = isl_basic_map_total_dim(bmap);
 	if (isl_basic_map_free_div(bmap, bmap->n_div) < 0)
@@ -2316,7 +2463,7 @@ __isl_give isl_basic_map *isl_basic_map_drop_div(
 	int i;
 	unsigned pos;
 
-	if (!bmap)
+	if (isl_basic_map_own_constraints(bmap) < 0)
 		goto error;
 
 	pos = 1 + isl_space_dim(bmap->dim, isl_dim_all) + div;
@@ -3324,7 +3471,7 @@ void isl_basic_map_print_internal(struct isl_basic_map *bmap,
 int isl_inequality_negate(struct isl_basic_map *bmap, unsigned pos)
 {
 	unsigned total;
-	if (!bmap)
+	if (isl_basic_map_own_constraints(bmap) < 0)
 		return -1;
 	total = isl_basic_map_total_dim(bmap);
 	isl_assert(bmap->ctx, pos < bmap->n_ineq, return -1);
@@ -4022,7 +4169,7 @@ __isl_give isl_basic_map *isl_basic_map_move_dims(
 	if (pos(bmap->dim, dst_type) + dst_pos ==
 	    pos(bmap->dim, src_type) + src_pos +
 					    ((src_type < dst_type) ? n : 0)) {
-		bmap = isl_basic_map_cow(bmap);
+		bmap = isl_basic_map_cow_space(bmap);
 		if (!bmap)
 			return NULL;
 
@@ -5480,7 +5627,7 @@ __isl_give isl_basic_map *isl_basic_map_reset_space(
 		isl_space_free(space);
 		return bmap;
 	}
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap || !space)
 		goto error;
 
@@ -8736,6 +8883,8 @@ __isl_give isl_basic_map *isl_basic_map_order_divs(
 			isl_die(isl_basic_map_get_ctx(bmap), isl_error_internal,
 				"integer division depends on itself",
 				return isl_basic_map_free(bmap));
+		if (isl_basic_map_own_constraints(bmap) < 0)
+			return isl_basic_map_free(bmap);
 		isl_basic_map_swap_div(bmap, i, i + pos);
 		--i;
 	}
@@ -8918,8 +9067,11 @@ __isl_give isl_basic_map *isl_basic_map_align_divs(
 			if (isl_basic_map_add_div_constraints(dst, j) < 0)
 				return isl_basic_map_free(dst);
 		}
-		if (j != i)
+		if (j != i) {
+			if (isl_basic_map_own_constraints(dst) < 0)
+				return isl_basic_map_free(dst);
 			isl_basic_map_swap_div(dst, i, j);
+		}
 	}
 	return dst;
 }
@@ -9667,6 +9819,42 @@ struct isl_set *isl_set_normalize(struct isl_set *set)
 	return set_from_map(isl_map_normalize(set_to_map(set)));
 }
 
+/* Are "map1" and "map2" represented in exactly the same way?
+ * That is, do they have the same space and the same basic maps,
+ * in the same order and with the same constraints in the same order?
+ * Unlike isl_map_plain_is_equal, this function does not normalize
+ * its inputs, so it does not modify their internal representation.
+ */
+isl_bool isl_map_plain_is_identical(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	int i;
+	isl_bool equal;
+
+	if (!map1 || !map2)
+		return isl_bool_error;
+
+	if (map1 == map2)
+		return isl_bool_true;
+	equal = isl_space_is_equal(map1->dim, map2->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	if (map1->n != map2->n)
+		return isl_bool_false;
+	for (i = 0; i < map1->n; ++i) {
+		if (isl_basic_map_plain_cmp(map1->p[i], map2->p[i]) != 0)
+			return isl_bool_false;
+	}
+
+	return isl_bool_true;
+}
+
+isl_bool isl_set_plain_is_identical(__isl_keep isl_set *set1,
+	__isl_keep isl_set *set2)
+{
+	return isl_map_plain_is_identical(set_to_map(set1), set_to_map(set2));
+}
+
 isl_bool isl_map_plain_is_equal(__isl_keep isl_map *map1,
 	__isl_keep isl_map *map2)
 {
@@ -10382,6 +10570,69 @@ uint32_t isl_set_get_hash(__isl_keep isl_set *set)
 	return isl_map_get_hash(set_to_map(set));
 }
 
+/* Return a hash value that digests the representation of "bmap",
+ * without normalizing it first.
+ * Basic maps that are represented in exactly the same way
+ * have the same hash value.
+ */
+static uint32_t isl_basic_map_plain_get_hash(__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	uint32_t hash = isl_hash_init();
+	unsigned total;
+
+	total = isl_basic_map_total_dim(bmap);
+	isl_hash_byte(hash, bmap->n_eq & 0xFF);
+	for (i = 0; i < bmap->n_eq; ++i) {
+		uint32_t c_hash;
+		c_hash = isl_seq_get_hash(bmap->eq[i], 1 + total);
+		isl_hash_hash(hash, c_hash);
+	}
+	isl_hash_byte(hash, bmap->n_ineq & 0xFF);
+	for (i = 0; i < bmap->n_ineq; ++i) {
+		uint32_t c_hash;
+		c_hash = isl_seq_get_hash(bmap->ineq[i], 1 + total);
+		isl_hash_hash(hash, c_hash);
+	}
+	isl_hash_byte(hash, bmap->n_div & 0xFF);
+	for (i = 0; i < bmap->n_div; ++i) {
+		uint32_t c_hash;
+		c_hash = isl_seq_get_hash(bmap->div[i], 1 + 1 + total);
+		isl_hash_hash(hash, c_hash);
+	}
+	return hash;
+}
+
+/* Return a hash value that digests the representation of "map",
+ * without normalizing it first.
+ * Maps that are considered identical by isl_map_plain_is_identical
+ * have the same hash value.
+ */
+uint32_t isl_map_plain_get_hash(__isl_keep isl_map *map)
+{
+	int i;
+	uint32_t hash, space_hash;
+
+	if (!map)
+		return 0;
+
+	hash = isl_hash_init();
+	space_hash = isl_space_get_hash(map->dim);
+	isl_hash_hash(hash, space_hash);
+	for (i = 0; i < map->n; ++i) {
+		uint32_t bmap_hash;
+		bmap_hash = isl_basic_map_plain_get_hash(map->p[i]);
+		isl_hash_hash(hash, bmap_hash);
+	}
+
+	return hash;
+}
+
+uint32_t isl_set_plain_get_hash(__isl_keep isl_set *set)
+{
+	return isl_map_plain_get_hash(set_to_map(set));
+}
+
 /* Return the number of basic maps in the (current) representation of "map".
  */
 int isl_map_n_basic_map(__isl_keep isl_map *map)
@@ -11307,7 +11558,7 @@ isl_bool isl_map_range_is_wrapping(__isl_keep isl_map *map)
 
 __isl_give isl_basic_set *isl_basic_map_wrap(__isl_take isl_basic_map *bmap)
 {
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 
@@ -11366,7 +11617,7 @@ __isl_give isl_basic_map *isl_basic_map_reset(__isl_take isl_basic_map *bmap,
 	if (!isl_space_is_named_or_nested(bmap->dim, type))
 		return bmap;
 
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 
@@ -11420,7 +11671,7 @@ __isl_give isl_basic_map *isl_basic_map_flatten(__isl_take isl_basic_map *bmap)
 	if (!bmap->dim->nested[0] && !bmap->dim->nested[1])
 		return bmap;
 
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 
@@ -11450,7 +11701,7 @@ __isl_give isl_basic_map *isl_basic_map_flatten_domain(
 	if (!bmap->dim->nested[0])
 		return bmap;
 
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 
@@ -11475,7 +11726,7 @@ __isl_give isl_basic_map *isl_basic_map_flatten_range(
 	if (!bmap->dim->nested[1])
 		return bmap;
 
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 
@@ -12037,7 +12288,7 @@ __isl_give isl_basic_map *isl_basic_map_curry(__isl_take isl_basic_map *bmap)
 	if (!isl_basic_map_can_curry(bmap))
 		isl_die(bmap->ctx, isl_error_invalid,
 			"basic map cannot be curried", goto error);
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 	bmap->dim = isl_space_curry(bmap->dim);
@@ -12116,7 +12367,7 @@ __isl_give isl_basic_map *isl_basic_map_uncurry(__isl_take isl_basic_map *bmap)
 		isl_die(bmap->ctx, isl_error_invalid,
 			"basic map cannot be uncurried",
 			return isl_basic_map_free(bmap));
-	bmap = isl_basic_map_cow(bmap);
+	bmap = isl_basic_map_cow_space(bmap);
 	if (!bmap)
 		return NULL;
 	bmap->dim = isl_space_uncurry(bmap->dim);
@@ -13473,6 +13724,8 @@ __isl_give isl_basic_map *isl_basic_map_set_div_expr_constant_num_si_inplace(
 {
 	if (isl_basic_map_check_range(bmap, isl_dim_div, div, 1) < 0)
 		return isl_basic_map_free(bmap);
+	if (isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
 
 	isl_int_set_si(bmap->div[div][1], value);
 
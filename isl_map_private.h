@@ -32,6 +32,14 @@
  * n_in is the number of in variables
  * n_out is the number of out variables
  * n_in + n_out should be equal to set.dim
+ *
+ * "block" and "block2" hold the constraints and the integer divisions.
+ * They may be shared with other basic maps that only differ
+ * in their space, in which case "block_ref" points to the number
+ * of basic maps sharing the blocks.  Otherwise, "block_ref" is NULL.
+ * The blocks need to be made private to the basic map
+ * (see isl_basic_map_own_constraints) before any of the constraints
+ * or integer divisions are modified.
  */
 struct isl_basic_map {
 	int ref;
@@ -75,6 +83,7 @@ struct isl_basic_map {
 
 	struct isl_blk block;
 	struct isl_blk block2;
+	int *block_ref;
 };
 
 #undef EL
@@ -128,6 +137,7 @@ __isl_give isl_basic_set *isl_basic_set_extend_constraints(
 __isl_give isl_basic_set *isl_basic_set_finalize(
 	__isl_take isl_basic_set *bset);
 __isl_give isl_basic_set *isl_basic_set_dup(__isl_keep isl_basic_set *bset);
+__isl_give isl_basic_map *isl_basic_map_dup(__isl_keep isl_basic_map *bmap);
 __isl_give isl_basic_set *isl_basic_set_simplify(
 	__isl_take isl_basic_set *bset);
 
@@ -254,6 +264,9 @@ int isl_inequality_negate(struct isl_basic_map *bmap, unsigned pos);
 
 __isl_give isl_basic_set *isl_basic_set_cow(__isl_take isl_basic_set *bset);
 __isl_give isl_basic_map *isl_basic_map_cow(__isl_take isl_basic_map *bmap);
+__isl_give isl_basic_map *isl_basic_map_cow_space(
+	__isl_take isl_basic_map *bmap);
+isl_stat isl_basic_map_own_constraints(__isl_keep isl_basic_map *bmap);
 __isl_give isl_set *isl_set_cow(__isl_take isl_set *set);
 __isl_give isl_map *isl_map_cow(__isl_take isl_map *map);
 
@@ -298,6 +311,12 @@ int isl_basic_map_plain_cmp(__isl_keep isl_basic_map *bmap1,
 	__isl_keep isl_basic_map *bmap2);
 isl_bool isl_basic_map_plain_is_equal(__isl_keep isl_basic_map *bmap1,
 	__isl_keep isl_basic_map *bmap2);
+uint32_t isl_map_plain_get_hash(__isl_keep isl_map *map);
+uint32_t isl_set_plain_get_hash(__isl_keep isl_set *set);
+isl_bool isl_map_plain_is_identical(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2);
+isl_bool isl_set_plain_is_identical(__isl_keep isl_set *set1,
+	__isl_keep isl_set *set2);
 __isl_give isl_basic_map *isl_basic_map_normalize_constraints(
 	__isl_take isl_basic_map *bmap);
 __isl_give isl_basic_set *isl_basic_set_normalize_constraints(
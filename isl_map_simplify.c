@@ -13,6 +13,7 @@
  * B.P. 105 - 78153 Le Chesnay, France
  */
 
+#include <string.h>
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include "isl_equalities.h"
@@ -51,8 +52,8 @@ __isl_give isl_basic_map *isl_basic_map_normalize_constraints(
 	isl_int gcd;
 	unsigned total = isl_basic_map_total_dim(bmap);
 
-	if (!bmap)
-		return NULL;
+	if (isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
 
 	isl_int_init(gcd);
 	for (i = bmap->n_eq - 1; i >= 0; --i) {
@@ -554,6 +555,8 @@ __isl_give isl_basic_map *isl_basic_map_gauss(__isl_take isl_basic_map *bmap,
 
 	if (!bmap)
 		return NULL;
+	if (bmap->n_eq > 0 && isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
 
 	total = isl_basic_map_total_dim(bmap);
 	total_var = total - bmap->n_div;
@@ -1157,6 +1160,60 @@ static __isl_give isl_basic_map *check_for_div_constraints(
 	return bmap;
 }
 
+/* Possible values for the elements of the "pair" array
+ * of isl_basic_map_remove_duplicate_constraints.
+ * ISL_INEQ_KEEP means that the inequality is not part of a pair
+ * of opposite inequalities that form an equality.
+ * ISL_INEQ_TO_EQ means that the inequality is the first of such a pair and
+ * ISL_INEQ_DROP means that it is the second.
+ */
+#define ISL_INEQ_KEEP	0
+#define ISL_INEQ_TO_EQ	1
+#define ISL_INEQ_DROP	2
+
+/* Turn each pair of opposite inequality constraints marked in "pair"
+ * into an equality constraint.
+ * The second constraint of a pair is dropped, while the first
+ * is turned into an equality.
+ *
+ * Both dropping an inequality and turning it into an equality
+ * only move the inequality at the given position and the last inequality.
+ * Handling the positions in decreasing order therefore ensures
+ * that the inequalities that still need to be handled remain
+ * at their original positions.
+ */
+static __isl_give isl_basic_map *inequality_pairs_to_equalities(
+	__isl_take isl_basic_map *bmap, int *pair)
+{
+	int k;
+
+	for (k = bmap->n_ineq - 1; k >= 0; --k) {
+		if (pair[k] == ISL_INEQ_DROP)
+			isl_basic_map_drop_inequality(bmap, k);
+		else if (pair[k] == ISL_INEQ_TO_EQ)
+			isl_basic_map_inequality_to_equality(bmap, k);
+	}
+
+	return bmap;
+}
+
+/* Remove duplicate inequality constraints from "bmap", keeping
+ * the tightest one of each group of constraints that only differ
+ * in their constant terms, and look for pairs of opposite
+ * inequality constraints.
+ * If the constant terms of such a pair add up to a negative value,
+ * then "bmap" is empty.
+ * If they add up to zero, then the pair is replaced by an equality.
+ * If they add up to a positive value and "detect_divs" is set,
+ * then try and use the pair to define an integer division.
+ *
+ * All pairs that add up to zero are marked in "pair" in a single pass
+ * over the inequalities and only turned into equalities afterwards,
+ * since the hash table refers to the positions of the inequalities.
+ * Since duplicate constraints have been removed at that point,
+ * each inequality has at most one opposite inequality and
+ * each pair is only marked from its first element.
+ */
 __isl_give isl_basic_map *isl_basic_map_remove_duplicate_constraints(
 	__isl_take isl_basic_map *bmap, int *progress, int detect_divs)
 {
@@ -1164,9 +1221,14 @@ __isl_give isl_basic_map *isl_basic_map_remove_duplicate_constraints(
 	int k, l, h;
 	unsigned total = isl_basic_map_total_dim(bmap);
 	isl_int sum;
+	int *pair = NULL;
+	int n_pair = 0;
+	isl_bool empty = isl_bool_false;
 
 	if (!bmap || bmap->n_ineq <= 1)
 		return bmap;
+	if (isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
 
 	if (create_constraint_index(&ci, bmap) < 0)
 		return bmap;
@@ -1200,47 +1262,54 @@ __isl_give isl_basic_map *isl_basic_map_remove_duplicate_constraints(
 			if (detect_divs)
 				bmap = check_for_div_constraints(bmap, k, l,
 								 sum, progress);
+			if (!bmap)
+				break;
 			continue;
 		}
 		if (isl_int_is_zero(sum)) {
-			/* We need to break out of the loop after these
-			 * changes since the contents of the hash
-			 * will no longer be valid.
-			 * Plus, we probably we want to regauss first.
-			 */
-			if (progress)
-				*progress = 1;
-			isl_basic_map_drop_inequality(bmap, l);
-			isl_basic_map_inequality_to_equality(bmap, k);
-		} else
-			bmap = isl_basic_map_set_to_empty(bmap);
+			if (l < k)
+				continue;
+			if (!pair) {
+				pair = isl_calloc_array(bmap->ctx, int,
+							bmap->n_ineq);
+				if (!pair) {
+					bmap = isl_basic_map_free(bmap);
+					break;
+				}
+			}
+			pair[k] = ISL_INEQ_TO_EQ;
+			pair[l] = ISL_INEQ_DROP;
+			n_pair++;
+			continue;
+		}
+		empty = isl_bool_true;
 		break;
 	}
 	isl_int_clear(sum);
 
 	constraint_index_free(&ci);
+
+	if (empty)
+		bmap = isl_basic_map_set_to_empty(bmap);
+	else if (n_pair > 0) {
+		if (progress)
+			*progress = 1;
+		bmap = inequality_pairs_to_equalities(bmap, pair);
+	}
+	free(pair);
+
 	return bmap;
 }
 
 /* Detect all pairs of inequalities that form an equality.
  *
- * isl_basic_map_remove_duplicate_constraints detects at most one such pair.
- * Call it repeatedly while it is making progress.
+ * isl_basic_map_remove_duplicate_constraints detects all such pairs
+ * in a single call.
  */
 __isl_give isl_basic_map *isl_basic_map_detect_inequality_pairs(
 	__isl_take isl_basic_map *bmap, int *progress)
 {
-	int duplicate;
-
-	do {
-		duplicate = 0;
-		bmap = isl_basic_map_remove_duplicate_constraints(bmap,
-								&duplicate, 0);
-		if (progress && duplicate)
-			*progress = 1;
-	} while (duplicate);
-
-	return bmap;
+	return isl_basic_map_remove_duplicate_constraints(bmap, progress, 0);
 }
 
 /* Eliminate knowns divs from constraints where they appear with
@@ -1339,8 +1408,8 @@ static __isl_give isl_basic_map *eliminate_unit_divs(
 __isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
 {
 	int progress = 1;
-	if (!bmap)
-		return NULL;
+	if (isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
 	while (progress) {
 		isl_bool empty;
 
@@ -1532,16 +1601,313 @@ static __isl_give isl_basic_map *remove_dependent_vars(
 	return bmap;
 }
 
+/* The ancestors of the inequality constraints of a basic map
+ * during the elimination of variables using Fourier-Motzkin.
+ *
+ * "n_word" is the number of 32-bit words in an ancestor set.
+ * "size" is the number of inequality constraints for which room
+ * has been allocated.
+ * "set" contains the ancestor set of inequality constraint k
+ * at position k * n_word.  An ancestor set contains the original
+ * inequality constraints that were combined to obtain the constraint.
+ * "tight" is set for an inequality constraint if it was derived
+ * from an inequality constraint with a tightened constant term.
+ * Such a constraint is not a non-negative combination of its ancestors.
+ * "n_elim" is the number of variables eliminated since the ancestor sets
+ * were last reset.
+ */
+struct isl_fm_history {
+	int n_word;
+	int size;
+	uint32_t *set;
+	int *tight;
+	int n_elim;
+};
+
+/* Free the memory allocated for the ancestor sets in "h".
+ */
+static void fm_history_clear(struct isl_fm_history *h)
+{
+	free(h->set);
+	free(h->tight);
+	h->set = NULL;
+	h->tight = NULL;
+	h->size = 0;
+}
+
+/* Make sure "h" has room for the ancestor sets of "size"
+ * inequality constraints.
+ */
+static isl_stat fm_history_extend(isl_ctx *ctx, struct isl_fm_history *h,
+	int size)
+{
+	uint32_t *set;
+	int *tight;
+
+	if (size <= h->size)
+		return isl_stat_ok;
+	set = isl_realloc_array(ctx, h->set, uint32_t, size * h->n_word);
+	if (!set)
+		return isl_stat_error;
+	h->set = set;
+	tight = isl_realloc_array(ctx, h->tight, int, size);
+	if (!tight)
+		return isl_stat_error;
+	h->tight = tight;
+	h->size = size;
+	return isl_stat_ok;
+}
+
+/* Reset the ancestor sets in "h" such that each inequality constraint
+ * of "bmap" is considered to be an original constraint.
+ */
+static isl_stat fm_history_reset(struct isl_fm_history *h,
+	__isl_keep isl_basic_map *bmap)
+{
+	int k;
+
+	fm_history_clear(h);
+	h->n_word = 1 + bmap->n_ineq / 32;
+	h->n_elim = 0;
+	if (fm_history_extend(bmap->ctx, h, bmap->n_ineq) < 0)
+		return isl_stat_error;
+	for (k = 0; k < bmap->n_ineq; ++k) {
+		memset(h->set + k * h->n_word, 0,
+			h->n_word * sizeof(uint32_t));
+		h->set[k * h->n_word + k / 32] = (uint32_t) 1 << (k % 32);
+		h->tight[k] = 0;
+	}
+	return isl_stat_ok;
+}
+
+/* Swap the ancestor sets of inequality constraints "a" and "b" in "h".
+ */
+static void fm_history_swap(struct isl_fm_history *h, int a, int b)
+{
+	int i, t;
+	uint32_t w;
+
+	if (a == b)
+		return;
+	for (i = 0; i < h->n_word; ++i) {
+		w = h->set[a * h->n_word + i];
+		h->set[a * h->n_word + i] = h->set[b * h->n_word + i];
+		h->set[b * h->n_word + i] = w;
+	}
+	t = h->tight[a];
+	h->tight[a] = h->tight[b];
+	h->tight[b] = t;
+}
+
+/* Drop inequality constraint "k" of "bmap", along with its ancestor set
+ * in "h".  isl_basic_map_drop_inequality moves the last inequality
+ * constraint to position "k", so the same is done in "h".
+ */
+static void fm_drop_inequality(__isl_keep isl_basic_map *bmap,
+	struct isl_fm_history *h, int k)
+{
+	fm_history_swap(h, k, bmap->n_ineq - 1);
+	isl_basic_map_drop_inequality(bmap, k);
+}
+
+/* Set the ancestor set of inequality constraint "k" in "h"
+ * to the union of those of inequality constraints "i" and "j" and
+ * return the number of elements in this union.
+ */
+static int fm_history_combine(struct isl_fm_history *h, int k, int i, int j)
+{
+	int l, n = 0;
+
+	for (l = 0; l < h->n_word; ++l) {
+		uint32_t w;
+
+		w = h->set[i * h->n_word + l] | h->set[j * h->n_word + l];
+		h->set[k * h->n_word + l] = w;
+		for (; w; w &= w - 1)
+			n++;
+	}
+	h->tight[k] = h->tight[i] || h->tight[j];
+	return n;
+}
+
+/* Combine inequality constraints "i" and "j" of "bmap", which have
+ * opposite signs for the coefficient of variable "d", into
+ * a new inequality constraint that does not involve "d".
+ *
+ * After eliminating h->n_elim variables, a combination of more than
+ * h->n_elim + 1 original inequality constraints is redundant
+ * with respect to the combinations of fewer original constraints
+ * (Chernikov's rule).  Such combinations are not added to "bmap".
+ * The rule only applies to actual non-negative combinations of
+ * the original constraints, so constraints derived from tightened
+ * constraints are always kept.
+ */
+static __isl_give isl_basic_map *add_fm_combination(
+	__isl_take isl_basic_map *bmap, struct isl_fm_history *h,
+	int i, int j, int d, unsigned total)
+{
+	int k, n;
+
+	k = isl_basic_map_alloc_inequality(bmap);
+	if (k < 0)
+		return isl_basic_map_free(bmap);
+	n = fm_history_combine(h, k, i, j);
+	if (!h->tight[k] && n > h->n_elim + 1) {
+		isl_basic_map_free_inequality(bmap, 1);
+		return bmap;
+	}
+	isl_seq_cpy(bmap->ineq[k], bmap->ineq[i], 1 + total);
+	isl_seq_elim(bmap->ineq[k], bmap->ineq[j], 1 + d, 1 + total, NULL);
+	return bmap;
+}
+
+/* Normalize the inequality constraints of "bmap" in the same way
+ * as isl_basic_map_normalize_constraints, keeping track
+ * of the corresponding ancestor sets in "h".
+ * An inequality constraint whose constant term gets tightened
+ * is marked in "h".
+ */
+static __isl_give isl_basic_map *fm_normalize_inequalities(
+	__isl_take isl_basic_map *bmap, struct isl_fm_history *h)
+{
+	int i;
+	isl_int gcd;
+	unsigned total = isl_basic_map_total_dim(bmap);
+	int rational = ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL);
+
+	isl_int_init(gcd);
+	for (i = bmap->n_ineq - 1; i >= 0; --i) {
+		isl_seq_gcd(bmap->ineq[i] + 1, total, &gcd);
+		if (isl_int_is_zero(gcd)) {
+			if (isl_int_is_neg(bmap->ineq[i][0])) {
+				bmap = isl_basic_map_set_to_empty(bmap);
+				break;
+			}
+			fm_drop_inequality(bmap, h, i);
+			continue;
+		}
+		if (rational)
+			isl_int_gcd(gcd, gcd, bmap->ineq[i][0]);
+		if (isl_int_is_one(gcd))
+			continue;
+		if (!isl_int_is_divisible_by(bmap->ineq[i][0], gcd))
+			h->tight[i] = 1;
+		isl_int_fdiv_q(bmap->ineq[i][0], bmap->ineq[i][0], gcd);
+		isl_seq_scale_down(bmap->ineq[i] + 1, bmap->ineq[i] + 1,
+				    gcd, total);
+	}
+	isl_int_clear(gcd);
+
+	return bmap;
+}
+
+/* Remove duplicate inequality constraints from "bmap", keeping
+ * the tightest one of each group of constraints that only differ
+ * in their constant terms, and keeping track of the corresponding
+ * ancestor sets in "h".
+ * If a pair of opposite inequality constraints has constant terms
+ * that add up to a negative value, then "bmap" is marked empty.
+ * Unlike isl_basic_map_remove_duplicate_constraints, no equality
+ * constraints are introduced since they would have to be used
+ * to simplify the other constraints, which would invalidate
+ * the ancestor sets.
+ */
+static __isl_give isl_basic_map *fm_remove_duplicate_inequalities(
+	__isl_take isl_basic_map *bmap, struct isl_fm_history *h)
+{
+	struct isl_constraint_index ci;
+	int k, l, hash;
+	unsigned total = isl_basic_map_total_dim(bmap);
+	isl_int sum;
+	int empty = 0;
+
+	if (!bmap || bmap->n_ineq <= 1)
+		return bmap;
+	if (create_constraint_index(&ci, bmap) < 0)
+		return isl_basic_map_free(bmap);
+
+	for (k = 0; k < bmap->n_ineq; ++k) {
+		hash = hash_index(&ci, bmap, k);
+		if (!ci.index[hash]) {
+			ci.index[hash] = &bmap->ineq[k];
+			continue;
+		}
+		l = ci.index[hash] - &bmap->ineq[0];
+		if (isl_int_lt(bmap->ineq[k][0], bmap->ineq[l][0])) {
+			swap_inequality(bmap, k, l);
+			fm_history_swap(h, k, l);
+		}
+		fm_drop_inequality(bmap, h, k);
+		--k;
+	}
+	isl_int_init(sum);
+	for (k = 0; k < bmap->n_ineq; ++k) {
+		isl_seq_neg(bmap->ineq[k] + 1, bmap->ineq[k] + 1, total);
+		hash = hash_index(&ci, bmap, k);
+		isl_seq_neg(bmap->ineq[k] + 1, bmap->ineq[k] + 1, total);
+		if (!ci.index[hash])
+			continue;
+		l = ci.index[hash] - &bmap->ineq[0];
+		isl_int_add(sum, bmap->ineq[k][0], bmap->ineq[l][0]);
+		if (isl_int_is_neg(sum)) {
+			empty = 1;
+			break;
+		}
+	}
+	isl_int_clear(sum);
+	constraint_index_free(&ci);
+
+	if (empty)
+		bmap = isl_basic_map_set_to_empty(bmap);
+	return bmap;
+}
+
+/* Perform the simplifications that were postponed during
+ * the elimination of variables using Fourier-Motzkin and
+ * reset the ancestor sets in "h" to the resulting inequality constraints.
+ */
+static __isl_give isl_basic_map *fm_simplify(__isl_take isl_basic_map *bmap,
+	struct isl_fm_history *h)
+{
+	bmap = isl_basic_map_normalize_constraints(bmap);
+	bmap = isl_basic_map_remove_duplicate_constraints(bmap, NULL, 0);
+	bmap = isl_basic_map_gauss(bmap, NULL);
+	bmap = isl_basic_map_remove_redundancies(bmap);
+	if (!bmap)
+		return NULL;
+	if (fm_history_reset(h, bmap) < 0)
+		return isl_basic_map_free(bmap);
+	return bmap;
+}
+
 /* Eliminate the specified variables from the constraints using
  * Fourier-Motzkin.  The variables themselves are not removed.
+ *
+ * The combinations of the lower and upper bounds on a variable are
+ * constructed in a single batch.  Only the cheap simplifications,
+ * i.e., normalization of the inequality constraints and removal
+ * of duplicates through a hash table, are performed after
+ * eliminating each variable.  The more expensive removal of
+ * redundant constraints is only performed after all variables
+ * have been eliminated or when the number of inequality constraints
+ * has grown too large.  In between, the ancestor sets of
+ * the inequality constraints are tracked such that combinations
+ * that are known to be redundant by Chernikov's rule can be dropped
+ * as soon as they are constructed.
+ * Since the equality constraints of the original basic map are
+ * not combinations of any inequality constraint, using them
+ * to eliminate a variable does not affect the ancestor sets.
  */
 __isl_give isl_basic_map *isl_basic_map_eliminate_vars(
 	__isl_take isl_basic_map *bmap, unsigned pos, unsigned n)
 {
 	int d;
-	int i, j, k;
+	int i, j;
 	unsigned total;
 	int need_gauss = 0;
+	int need_simplify = 0;
+	int limit;
+	struct isl_fm_history h = { 0 };
 
 	if (n == 0)
 		return bmap;
@@ -1558,10 +1924,13 @@ __isl_give isl_basic_map *isl_basic_map_eliminate_vars(
 	for (d = pos + n - 1;
 	     d >= 0 && d >= total - bmap->n_div && d >= pos; --d)
 		isl_seq_clr(bmap->div[d-(total-bmap->n_div)], 2+total);
+	if (fm_history_reset(&h, bmap) < 0)
+		goto error;
+	limit = 8 * (bmap->n_ineq + total);
 	for (d = pos + n - 1; d >= 0 && d >= pos; --d) {
 		int n_lower, n_upper;
 		if (!bmap)
-			return NULL;
+			goto error;
 		for (i = 0; i < bmap->n_eq; ++i) {
 			if (isl_int_is_zero(bmap->eq[i][1+d]))
 				continue;
@@ -1584,6 +1953,10 @@ __isl_give isl_basic_map *isl_basic_map_eliminate_vars(
 				0, n_lower * n_upper);
 		if (!bmap)
 			goto error;
+		if (fm_history_extend(bmap->ctx, &h,
+				    bmap->n_ineq + n_lower * n_upper) < 0)
+			goto error;
+		h.n_elim++;
 		for (i = bmap->n_ineq - 1; i >= 0; --i) {
 			int last;
 			if (isl_int_is_zero(bmap->ineq[i][1+d]))
@@ -1596,35 +1969,47 @@ __isl_give isl_basic_map *isl_basic_map_eliminate_vars(
 				if (isl_int_sgn(bmap->ineq[i][1+d]) ==
 				    isl_int_sgn(bmap->ineq[j][1+d]))
 					continue;
-				k = isl_basic_map_alloc_inequality(bmap);
-				if (k < 0)
+				bmap = add_fm_combination(bmap, &h,
+							i, j, d, total);
+				if (!bmap)
 					goto error;
-				isl_seq_cpy(bmap->ineq[k], bmap->ineq[i],
-						1+total);
-				isl_seq_elim(bmap->ineq[k], bmap->ineq[j],
-						1+d, 1+total, NULL);
 			}
-			isl_basic_map_drop_inequality(bmap, i);
+			fm_drop_inequality(bmap, &h, i);
 			i = last + 1;
 		}
 		if (n_lower > 0 && n_upper > 0) {
-			bmap = isl_basic_map_normalize_constraints(bmap);
-			bmap = isl_basic_map_remove_duplicate_constraints(bmap,
-								    NULL, 0);
-			bmap = isl_basic_map_gauss(bmap, NULL);
-			bmap = isl_basic_map_remove_redundancies(bmap);
+			bmap = fm_normalize_inequalities(bmap, &h);
+			bmap = fm_remove_duplicate_inequalities(bmap, &h);
+			need_simplify = 1;
+			if (!bmap)
+				goto error;
+			if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
+				break;
+		}
+		if (need_simplify && bmap->n_ineq > limit) {
+			bmap = fm_simplify(bmap, &h);
 			need_gauss = 0;
+			need_simplify = 0;
 			if (!bmap)
 				goto error;
 			if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
 				break;
+			limit = 8 * (bmap->n_ineq + total);
 		}
 	}
+	if (need_simplify && !ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY)) {
+		bmap = fm_simplify(bmap, &h);
+		need_gauss = 0;
+	}
+	fm_history_clear(&h);
+	if (!bmap)
+		return NULL;
 	ISL_F_CLR(bmap, ISL_BASIC_MAP_NORMALIZED);
 	if (need_gauss)
 		bmap = isl_basic_map_gauss(bmap, NULL);
 	return bmap;
 error:
+	fm_history_clear(&h);
 	isl_basic_map_free(bmap);
 	return NULL;
 }
@@ -5186,8 +5571,8 @@ __isl_give isl_basic_map *isl_basic_map_shift_div(
 
 	if (isl_int_is_zero(shift))
 		return bmap;
-	if (!bmap)
-		return NULL;
+	if (isl_basic_map_own_constraints(bmap) < 0)
+		return isl_basic_map_free(bmap);
 
 	total = isl_basic_map_dim(bmap, isl_dim_all);
 	total -= isl_basic_map_dim(bmap, isl_dim_div);
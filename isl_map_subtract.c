@@ -12,6 +12,7 @@
 #include <isl/set.h>
 #include <isl/map.h>
 #include "isl_tab.h"
+#include <isl_lp_private.h>
 #include <isl_point_private.h>
 #include <isl_vec_private.h>
 
@@ -52,14 +53,12 @@ static isl_stat tab_add_constraints(struct isl_tab *tab,
 	int i;
 	unsigned dim;
 	unsigned tab_total;
-	unsigned bmap_total;
 	isl_vec *v;
 
 	if (!tab || !bmap)
 		return isl_stat_error;
 
 	tab_total = isl_basic_map_total_dim(tab->bmap);
-	bmap_total = isl_basic_map_total_dim(bmap);
 	dim = isl_space_dim(tab->bmap->dim, isl_dim_all);
 
 	if (isl_tab_extend_cons(tab, 2 * bmap->n_eq + bmap->n_ineq) < 0)
@@ -73,11 +72,9 @@ static isl_stat tab_add_constraints(struct isl_tab *tab,
 		expand_constraint(v, dim, bmap->eq[i], div_map, bmap->n_div);
 		if (isl_tab_add_ineq(tab, v->el) < 0)
 			goto error;
-		isl_seq_neg(bmap->eq[i], bmap->eq[i], 1 + bmap_total);
-		expand_constraint(v, dim, bmap->eq[i], div_map, bmap->n_div);
+		isl_seq_neg(v->el, v->el, 1 + tab_total);
 		if (isl_tab_add_ineq(tab, v->el) < 0)
 			goto error;
-		isl_seq_neg(bmap->eq[i], bmap->eq[i], 1 + bmap_total);
 		if (tab->empty)
 			break;
 	}
@@ -111,7 +108,6 @@ static isl_stat tab_add_constraint(struct isl_tab *tab,
 {
 	unsigned dim;
 	unsigned tab_total;
-	unsigned bmap_total;
 	isl_vec *v;
 	isl_stat r;
 
@@ -119,7 +115,6 @@ static isl_stat tab_add_constraint(struct isl_tab *tab,
 		return isl_stat_error;
 
 	tab_total = isl_basic_map_total_dim(tab->bmap);
-	bmap_total = isl_basic_map_total_dim(bmap);
 	dim = isl_space_dim(tab->bmap->dim, isl_dim_all);
 
 	v = isl_vec_alloc(bmap->ctx, 1 + tab_total);
@@ -127,33 +122,18 @@ static isl_stat tab_add_constraint(struct isl_tab *tab,
 		return isl_stat_error;
 
 	if (c < 2 * bmap->n_eq) {
-		if ((c % 2) != oppose)
-			isl_seq_neg(bmap->eq[c/2], bmap->eq[c/2],
-					1 + bmap_total);
-		if (oppose)
-			isl_int_sub_ui(bmap->eq[c/2][0], bmap->eq[c/2][0], 1);
 		expand_constraint(v, dim, bmap->eq[c/2], div_map, bmap->n_div);
-		r = isl_tab_add_ineq(tab, v->el);
-		if (oppose)
-			isl_int_add_ui(bmap->eq[c/2][0], bmap->eq[c/2][0], 1);
 		if ((c % 2) != oppose)
-			isl_seq_neg(bmap->eq[c/2], bmap->eq[c/2],
-					1 + bmap_total);
+			isl_seq_neg(v->el, v->el, 1 + tab_total);
 	} else {
 		c -= 2 * bmap->n_eq;
-		if (oppose) {
-			isl_seq_neg(bmap->ineq[c], bmap->ineq[c],
-					1 + bmap_total);
-			isl_int_sub_ui(bmap->ineq[c][0], bmap->ineq[c][0], 1);
-		}
 		expand_constraint(v, dim, bmap->ineq[c], div_map, bmap->n_div);
-		r = isl_tab_add_ineq(tab, v->el);
-		if (oppose) {
-			isl_int_add_ui(bmap->ineq[c][0], bmap->ineq[c][0], 1);
-			isl_seq_neg(bmap->ineq[c], bmap->ineq[c],
-					1 + bmap_total);
-		}
+		if (oppose)
+			isl_seq_neg(v->el, v->el, 1 + tab_total);
 	}
+	if (oppose)
+		isl_int_sub_ui(v->el[0], v->el[0], 1);
+	r = isl_tab_add_ineq(tab, v->el);
 
 	isl_vec_free(v);
 	return r;
@@ -259,12 +239,63 @@ static int n_non_redundant(isl_ctx *ctx, struct isl_tab *tab,
 /* basic_map_collect_diff calls add on each of the pieces of
  * the set difference between bmap and map until the add method
  * return a negative value.
+ * If add_witness is set, then it is called instead of add
+ * on pieces that are known to be non-empty from the tableau alone,
+ * without an explicit description of the piece being constructed.
+ * This is only useful for callers that are not interested
+ * in the actual pieces.
  */
 struct isl_diff_collector {
 	isl_stat (*add)(struct isl_diff_collector *dc,
 		    __isl_take isl_basic_map *bmap);
+	isl_stat (*add_witness)(struct isl_diff_collector *dc);
 };
 
+/* Report the piece of the set difference represented by "tab"
+ * to "dc".
+ *
+ * If the tableau is empty, then so is the piece and nothing
+ * needs to be reported.
+ * If the sample value of the tableau is integral, then the piece
+ * is known to be non-empty.  If "dc" is only interested in
+ * the existence of such a piece, then report it through
+ * dc->add_witness, avoiding the construction of the piece and
+ * a separate emptiness check.
+ * Otherwise, extract the piece from "tab" and check that
+ * it is non-empty, unless this is already known, before passing it
+ * to dc->add.
+ */
+static isl_stat add_piece(struct isl_diff_collector *dc, struct isl_tab *tab)
+{
+	int integer;
+	isl_bool empty;
+	isl_basic_map *bm;
+
+	if (tab->empty)
+		return isl_stat_ok;
+	integer = isl_tab_sample_is_integer(tab);
+	if (integer < 0)
+		return isl_stat_error;
+	if (integer && dc->add_witness)
+		return dc->add_witness(dc);
+
+	bm = isl_basic_map_copy(tab->bmap);
+	bm = isl_basic_map_cow(bm);
+	bm = isl_basic_map_update_from_tab(bm, tab);
+	bm = isl_basic_map_simplify(bm);
+	bm = isl_basic_map_finalize(bm);
+	empty = integer ? isl_bool_false : isl_basic_map_is_empty(bm);
+	if (empty < 0 || !bm) {
+		isl_basic_map_free(bm);
+		return isl_stat_error;
+	}
+	if (empty) {
+		isl_basic_map_free(bm);
+		return isl_stat_ok;
+	}
+	return dc->add(dc, bm);
+}
+
 /* Compute the set difference between bmap and map and call
  * dc->add on each of the piece until this function returns
  * a negative value.
@@ -345,24 +376,12 @@ static isl_stat basic_map_collect_diff(__isl_take isl_basic_map *bmap,
 
 	while (level >= 0) {
 		if (level >= map->n) {
-			int empty;
-			struct isl_basic_map *bm;
 			if (!modified) {
 				if (dc->add(dc, isl_basic_map_copy(bmap)) < 0)
 					goto error;
 				break;
 			}
-			bm = isl_basic_map_copy(tab->bmap);
-			bm = isl_basic_map_cow(bm);
-			bm = isl_basic_map_update_from_tab(bm, tab);
-			bm = isl_basic_map_simplify(bm);
-			bm = isl_basic_map_finalize(bm);
-			empty = isl_basic_map_is_empty(bm);
-			if (empty)
-				isl_basic_map_free(bm);
-			else if (dc->add(dc, bm) < 0)
-				goto error;
-			if (empty < 0)
+			if (add_piece(dc, tab) < 0)
 				goto error;
 			level--;
 			init = 0;
@@ -490,6 +509,7 @@ static __isl_give isl_map *basic_map_subtract(__isl_take isl_basic_map *bmap,
 {
 	struct isl_subtract_diff_collector sdc;
 	sdc.dc.add = &basic_map_subtract_add;
+	sdc.dc.add_witness = NULL;
 	sdc.diff = isl_map_empty(isl_basic_map_get_space(bmap));
 	if (basic_map_collect_diff(bmap, map, &sdc.dc) < 0) {
 		isl_map_free(sdc.diff);
@@ -668,6 +688,19 @@ static isl_stat basic_map_is_empty_add(struct isl_diff_collector *dc,
 	return isl_stat_error;
 }
 
+/* isl_is_empty_diff_collector callback for pieces that are known
+ * to be non-empty.
+ */
+static isl_stat basic_map_is_empty_add_witness(struct isl_diff_collector *dc)
+{
+	struct isl_is_empty_diff_collector *edc;
+	edc = (struct isl_is_empty_diff_collector *)dc;
+
+	edc->empty = 0;
+
+	return isl_stat_error;
+}
+
 /* Check if bmap \ map is empty by computing this set difference
  * and breaking off as soon as the difference is known to be non-empty.
  */
@@ -683,6 +716,7 @@ static isl_bool basic_map_diff_is_empty(__isl_keep isl_basic_map *bmap,
 		return empty;
 
 	edc.dc.add = &basic_map_is_empty_add;
+	edc.dc.add_witness = &basic_map_is_empty_add_witness;
 	edc.empty = isl_bool_true;
 	r = basic_map_collect_diff(isl_basic_map_copy(bmap),
 				   isl_map_copy(map), &edc.dc);
@@ -823,11 +857,96 @@ static isl_bool map_is_singleton_subset(__isl_keep isl_map *map1,
 	return is_subset;
 }
 
+/* Is "bmap" an integer basic map without integer divisions
+ * such that each of its constraints involves at most one variable
+ * (including the parameters)?
+ * That is, is "bmap" a box with constant bounds?
+ */
+static isl_bool basic_map_plain_is_box(__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	unsigned total;
+
+	if (!bmap)
+		return isl_bool_error;
+	if (bmap->n_div != 0 || ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL))
+		return isl_bool_false;
+
+	total = isl_basic_map_total_dim(bmap);
+	for (i = 0; i < bmap->n_eq; ++i) {
+		int k = isl_seq_first_non_zero(bmap->eq[i] + 1, total);
+		if (k >= 0 && isl_seq_first_non_zero(bmap->eq[i] + 1 + k + 1,
+						total - k - 1) >= 0)
+			return isl_bool_false;
+	}
+	for (i = 0; i < bmap->n_ineq; ++i) {
+		int k = isl_seq_first_non_zero(bmap->ineq[i] + 1, total);
+		if (k >= 0 && isl_seq_first_non_zero(bmap->ineq[i] + 1 + k + 1,
+						total - k - 1) >= 0)
+			return isl_bool_false;
+	}
+
+	return isl_bool_true;
+}
+
+/* Can map_box_is_subset be used to check whether "map1"
+ * is a subset of "map2"?
+ * That is, does "map2" consist of a single basic map without
+ * integer divisions and are all basic maps of "map1" boxes
+ * with constant bounds?
+ */
+static isl_bool map_is_box_subset_pair(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	int i;
+
+	if (map2->n != 1 || map2->p[0]->n_div != 0)
+		return isl_bool_false;
+	for (i = 0; i < map1->n; ++i) {
+		isl_bool box = basic_map_plain_is_box(map1->p[i]);
+		if (box < 0 || !box)
+			return box;
+	}
+
+	return isl_bool_true;
+}
+
+/* Is "map1" a subset of "map2", where map_is_box_subset_pair
+ * is known to hold?
+ * Since each basic map of "map1" is a box with constant bounds,
+ * it is a subset of the single basic map of "map2"
+ * if and only if each constraint of this basic map attains
+ * a non-negative minimum over the box, which can be computed
+ * directly from the bounds.
+ */
+static isl_bool map_box_is_subset(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	int i;
+	isl_bool is_subset = isl_bool_true;
+
+	for (i = 0; is_subset == isl_bool_true && i < map1->n; ++i) {
+		struct isl_set_box *box;
+
+		box = isl_basic_map_plain_box(map1->p[i]);
+		is_subset = isl_set_box_is_subset(box, map2->p[0]);
+		isl_set_box_free(box);
+	}
+
+	return is_subset;
+}
+
+/* Is "map1" a subset of "map2"?
+ *
+ * If "map1" consists of boxes with constant bounds and "map2"
+ * of a single basic map without integer divisions, then
+ * the check can be performed directly on the bounds.
+ */
 static isl_bool map_is_subset(__isl_keep isl_map *map1,
 	__isl_keep isl_map *map2)
 {
 	isl_bool is_subset = isl_bool_false;
-	isl_bool empty, single;
+	isl_bool empty, single, box;
 	isl_bool rat1, rat2;
 
 	if (!map1 || !map2)
@@ -858,6 +977,12 @@ static isl_bool map_is_subset(__isl_keep isl_map *map1,
 	if (isl_map_plain_is_universe(map2))
 		return isl_bool_true;
 
+	box = map_is_box_subset_pair(map1, map2);
+	if (box < 0)
+		return isl_bool_error;
+	if (box)
+		return map_box_is_subset(map1, map2);
+
 	single = isl_map_plain_is_singleton(map1);
 	if (single < 0)
 		return isl_bool_error;
@@ -889,6 +1014,7 @@ __isl_give isl_map *isl_map_make_disjoint(__isl_take isl_map *map)
 	int i;
 	struct isl_subtract_diff_collector sdc;
 	sdc.dc.add = &basic_map_subtract_add;
+	sdc.dc.add_witness = NULL;
 
 	if (!map)
 		return NULL;
@@ -977,32 +977,71 @@ static isl_stat inv_exchange(__isl_keep isl_mat **left,
 	return isl_stat_ok;
 }
 
-static void inv_oppose(
-	struct isl_mat *left, struct isl_mat *right, unsigned row)
+/* Perform step "row" of fraction-free Gauss-Jordan elimination
+ * on the rows "i" of "left" and "right", with "i" different from "row".
+ * "prev" is the pivot of the previous step, or one for the first step.
+ *
+ * Each row is replaced by its combination with row "row"
+ * that eliminates the element in column "row", after which
+ * it is divided by "prev".  Bareiss' identity guarantees
+ * that this division is exact.  The elements of the rows before "row"
+ * in the columns before "row" are zero, except on the diagonal,
+ * where they are all equal to "prev" and are updated to the new pivot.
+ * "m" is used as temporary storage.
+ */
+static void inv_bareiss_step(__isl_keep isl_mat *left,
+	__isl_keep isl_mat *right, int row, isl_int prev, isl_int m)
 {
-	isl_seq_neg(left->row[row]+row, left->row[row]+row, left->n_col-row);
-	isl_seq_neg(right->row[row], right->row[row], right->n_col);
-}
+	int i;
+	isl_int *pivot = &left->row[row][row];
 
-static void inv_subtract(struct isl_mat *left, struct isl_mat *right,
-	unsigned row, unsigned i, isl_int m)
-{
-	isl_int_neg(m, m);
-	isl_seq_combine(left->row[i]+row,
-			left->ctx->one, left->row[i]+row,
-			m, left->row[row]+row,
-			left->n_col-row);
-	isl_seq_combine(right->row[i], right->ctx->one, right->row[i],
-			m, right->row[row], right->n_col);
+	for (i = 0; i < left->n_row; ++i) {
+		if (i == row)
+			continue;
+		isl_int_neg(m, left->row[i][row]);
+		isl_int_set_si(left->row[i][row], 0);
+		isl_seq_combine(left->row[i] + row + 1,
+				*pivot, left->row[i] + row + 1,
+				m, left->row[row] + row + 1,
+				left->n_col - (row + 1));
+		isl_seq_combine(right->row[i], *pivot, right->row[i],
+				m, right->row[row], right->n_col);
+		if (!isl_int_is_one(prev)) {
+			isl_seq_scale_down(left->row[i] + row + 1,
+					left->row[i] + row + 1, prev,
+					left->n_col - (row + 1));
+			isl_seq_scale_down(right->row[i], right->row[i], prev,
+					right->n_col);
+		}
+		if (i < row)
+			isl_int_set(left->row[i][i], *pivot);
+	}
 }
 
 /* Compute inv(left)*right
+ *
+ * If inv(left)*right is not integral, then the result is multiplied
+ * by the smallest positive integer that makes it integral.
+ *
+ * The computation is performed using fraction-free Gauss-Jordan
+ * elimination (Bareiss' algorithm) on the rows of "left" and "right".
+ * All intermediate elements are then (up to sign) minors
+ * of the augmented matrix [left right], such that their size
+ * is bounded by that of the input and of the final result.
+ * Pivots of smallest absolute value are selected to keep
+ * the intermediate results small.
+ * After the elimination, the diagonal elements of "left"
+ * are all equal to the (possibly negated) determinant and
+ * "right" is equal to inv(left)*right multiplied by this determinant.
+ * The greatest common divisor of the determinant and the elements
+ * of "right" is removed at the end, such that "right" is multiplied
+ * by the smallest positive integer that makes it integral.
  */
 __isl_give isl_mat *isl_mat_inverse_product(__isl_take isl_mat *left,
 	__isl_take isl_mat *right)
 {
 	int row;
-	isl_int a, b;
+	isl_int prev, m;
 
 	if (!left || !right)
 		goto error;
@@ -1020,68 +1059,36 @@ __isl_give isl_mat *isl_mat_inverse_product(__isl_take isl_mat *left,
 	if (!left || !right)
 		goto error;
 
-	isl_int_init(a);
-	isl_int_init(b);
+	isl_int_init(prev);
+	isl_int_init(m);
+	isl_int_set_si(prev, 1);
 	for (row = 0; row < left->n_row; ++row) {
-		int pivot, first, i, off;
+		int pivot;
 		pivot = row_abs_min_non_zero(left->row+row, left->n_row-row, row);
 		if (pivot < 0) {
-			isl_int_clear(a);
-			isl_int_clear(b);
+			isl_int_clear(prev);
+			isl_int_clear(m);
 			isl_assert(left->ctx, pivot >= 0, goto error);
 		}
 		pivot += row;
-		if (pivot != row)
-			if (inv_exchange(&left, &right, pivot, row) < 0)
-				goto error;
-		if (isl_int_is_neg(left->row[row][row]))
-			inv_oppose(left, right, row);
-		first = row+1;
-		while ((off = row_first_non_zero(left->row+first,
-					left->n_row-first, row)) != -1) {
-			first += off;
-			isl_int_fdiv_q(a, left->row[first][row],
-					left->row[row][row]);
-			inv_subtract(left, right, row, first, a);
-			if (!isl_int_is_zero(left->row[first][row])) {
-				if (inv_exchange(&left, &right, row, first) < 0)
-					goto error;
-			} else {
-				++first;
-			}
-		}
-		for (i = 0; i < row; ++i) {
-			if (isl_int_is_zero(left->row[i][row]))
-				continue;
-			isl_int_gcd(a, left->row[row][row], left->row[i][row]);
-			isl_int_divexact(b, left->row[i][row], a);
-			isl_int_divexact(a, left->row[row][row], a);
-			isl_int_neg(b, b);
-			isl_seq_combine(left->row[i] + i,
-					a, left->row[i] + i,
-					b, left->row[row] + i,
-					left->n_col - i);
-			isl_seq_combine(right->row[i], a, right->row[i],
-					b, right->row[row], right->n_col);
+		if (pivot != row &&
+		    inv_exchange(&left, &right, pivot, row) < 0) {
+			isl_int_clear(prev);
+			isl_int_clear(m);
+			goto error;
 		}
+		inv_bareiss_step(left, right, row, prev, m);
+		isl_int_set(prev, left->row[row][row]);
 	}
-	isl_int_clear(b);
-
-	isl_int_set(a, left->row[0][0]);
-	for (row = 1; row < left->n_row; ++row)
-		isl_int_lcm(a, a, left->row[row][row]);
-	if (isl_int_is_zero(a)){
-		isl_int_clear(a);
-		isl_assert(left->ctx, 0, goto error);
-	}
-	for (row = 0; row < left->n_row; ++row) {
-		isl_int_divexact(left->row[row][row], a, left->row[row][row]);
-		if (isl_int_is_one(left->row[row][row]))
-			continue;
-		isl_seq_scale(right->row[row], right->row[row],
-				left->row[row][row], right->n_col);
-	}
-	isl_int_clear(a);
+	if (isl_int_is_neg(prev))
+		for (row = 0; row < right->n_row; ++row)
+			isl_seq_neg(right->row[row], right->row[row],
+					right->n_col);
+	isl_mat_gcd(right, &m);
+	isl_int_gcd(m, m, prev);
+	right = isl_mat_scale_down(right, m);
+	isl_int_clear(prev);
+	isl_int_clear(m);
 
 	isl_mat_free(left);
 	return right;
@@ -1114,12 +1121,23 @@ void isl_mat_col_combine(struct isl_mat *mat, unsigned dst,
 	isl_int_clear(tmp);
 }
 
+/* Compute a right inverse of "mat", i.e., a matrix "inv" such that
+ * mat * inv is a positive multiple of the identity matrix.
+ *
+ * If "mat" is square, then its inverse is unique (up to a scalar multiple)
+ * and it is computed by isl_mat_inverse_product, which avoids
+ * the coefficient growth of the elimination below.
+ */
 __isl_give isl_mat *isl_mat_right_inverse(__isl_take isl_mat *mat)
 {
 	struct isl_mat *inv;
 	int row;
 	isl_int a, b;
 
+	if (mat && mat->n_row == mat->n_col)
+		return isl_mat_inverse_product(mat,
+					isl_mat_identity(mat->ctx, mat->n_row));
+
 	mat = isl_mat_cow(mat);
 	if (!mat)
 		return NULL;
@@ -37,7 +37,9 @@ __isl_give isl_mat *isl_mat_diag(isl_ctx *ctx, unsigned n_row, isl_int d);
 
 __isl_give isl_mat *isl_mat_reverse_gauss(__isl_take isl_mat *mat);
 
+void isl_mat_gcd(__isl_keep isl_mat *mat, isl_int *gcd);
 __isl_give isl_mat *isl_mat_scale(__isl_take isl_mat *mat, isl_int m);
+__isl_give isl_mat *isl_mat_scale_down(__isl_take isl_mat *mat, isl_int m);
 __isl_give isl_mat *isl_mat_scale_down_row(__isl_take isl_mat *mat, int row,
 	isl_int m);
 
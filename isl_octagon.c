@@ -0,0 +1,444 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#include <limits.h>
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include <isl_seq.h>
+#include <isl_vec_private.h>
+#include "isl_octagon.h"
+
+/* An octagon over n integer variables x_k, represented as
+ * a difference bound matrix over 2n nodes.
+ * Node 2k represents x_k and node 2k + 1 represents -x_k, such that
+ * the node representing the opposite of node i is i ^ 1.
+ * Writing V_i for the value represented by node i,
+ * the element in row i and column j of "m" is an upper bound
+ * on V_j - V_i, or OCT_INF if there is no such bound.
+ * In particular, a constraint V_i + V_j <= c is represented
+ * by the pair of bounds V_i - V_{j^1} <= c and V_j - V_{i^1} <= c,
+ * while a unary constraint V_i <= c is represented by V_i - V_{i^1} <= 2c.
+ *
+ * "n" is the number of nodes, i.e., twice the number of variables.
+ * "tmp" is scratch space for four rows.
+ */
+struct isl_octagon {
+	int n;
+	long *m;
+	long *tmp;
+};
+
+#define OCT_INF		LONG_MAX
+#define OCT(oct, i, j)	((oct)->m[(i) * (oct)->n + (j)])
+
+/* Return floor(a/b), with b > 0.
+ */
+static long floor_div(long a, long b)
+{
+	long q = a / b;
+
+	if (a % b != 0 && a < 0)
+		--q;
+	return q;
+}
+
+/* Is "c" a unit coefficient?
+ */
+static int is_unit(isl_int c)
+{
+	return isl_int_is_one(c) || isl_int_is_negone(c);
+}
+
+/* Find the positions of the first two non-zero coefficients
+ * of the variables in "c" (of length 1 + dim) and store them in "pos".
+ * Return the number of non-zero coefficients, or 3 if there are
+ * more than two.
+ */
+static int octagon_constraint_vars(isl_int *c, unsigned dim, int pos[2])
+{
+	int i, n = 0;
+
+	for (i = 0; i < dim; ++i) {
+		if (isl_int_is_zero(c[1 + i]))
+			continue;
+		if (n == 2)
+			return 3;
+		pos[n++] = i;
+	}
+
+	return n;
+}
+
+/* Can the constraint "c" (of length 1 + dim) be represented
+ * in an octagon with a constant term of absolute value at most "limit"?
+ * That is, does it involve at most two variables, with unit
+ * coefficients if it involves two variables?
+ * The coefficient of a single variable is allowed to be arbitrary
+ * as long as it fits in a long.
+ */
+static int is_octagonal_constraint(isl_int *c, unsigned dim, long limit)
+{
+	int pos[2];
+	long c0;
+
+	if (!isl_int_fits_slong(c[0]))
+		return 0;
+	c0 = isl_int_get_si(c[0]);
+	if (c0 > limit || c0 < -limit)
+		return 0;
+
+	switch (octagon_constraint_vars(c, dim, pos)) {
+	case 0:
+		return 1;
+	case 1:
+		return isl_int_fits_slong(c[1 + pos[0]]) &&
+			isl_int_get_si(c[1 + pos[0]]) != LONG_MIN;
+	case 2:
+		return is_unit(c[1 + pos[0]]) && is_unit(c[1 + pos[1]]);
+	default:
+		return 0;
+	}
+}
+
+/* Is "bset" an integer set that can be represented as an octagon?
+ * That is, does each of its constraints involve at most two variables,
+ * with unit coefficients if it involves two variables?
+ * Integer divisions are treated as ordinary variables,
+ * so the caller should only call this function on sets
+ * that do not involve any integer divisions.
+ *
+ * The constant terms are required to be small enough for
+ * all computations in isl_basic_set_octagon_sample to be performed
+ * on longs.  The bound on a difference computed there is (at most
+ * twice) the sum of the constant terms along a path through
+ * at most 2 * dim nodes.
+ */
+isl_bool isl_basic_set_is_octagon(__isl_keep isl_basic_set *bset)
+{
+	int i;
+	unsigned dim;
+	long limit;
+
+	if (!bset)
+		return isl_bool_error;
+	if (ISL_F_ISSET(bset, ISL_BASIC_SET_RATIONAL))
+		return isl_bool_false;
+
+	dim = isl_basic_set_total_dim(bset);
+	limit = LONG_MAX / (16 * ((long) dim + 1));
+	for (i = 0; i < bset->n_eq; ++i)
+		if (!is_octagonal_constraint(bset->eq[i], dim, limit))
+			return isl_bool_false;
+	for (i = 0; i < bset->n_ineq; ++i)
+		if (!is_octagonal_constraint(bset->ineq[i], dim, limit))
+			return isl_bool_false;
+
+	return isl_bool_true;
+}
+
+static void octagon_free(struct isl_octagon *oct)
+{
+	if (!oct)
+		return;
+	free(oct->m);
+	free(oct->tmp);
+	free(oct);
+}
+
+/* Construct an unconstrained octagon over "dim" variables.
+ */
+static struct isl_octagon *octagon_alloc(isl_ctx *ctx, unsigned dim)
+{
+	int i;
+	struct isl_octagon *oct;
+
+	oct = isl_calloc_type(ctx, struct isl_octagon);
+	if (!oct)
+		return NULL;
+	oct->n = 2 * dim;
+	oct->m = isl_alloc_array(ctx, long, oct->n * oct->n);
+	oct->tmp = isl_alloc_array(ctx, long, 4 * oct->n);
+	if ((oct->n && !oct->m) || (oct->n && !oct->tmp)) {
+		octagon_free(oct);
+		return NULL;
+	}
+
+	for (i = 0; i < oct->n * oct->n; ++i)
+		oct->m[i] = OCT_INF;
+	for (i = 0; i < oct->n; ++i)
+		OCT(oct, i, i) = 0;
+
+	return oct;
+}
+
+/* Add the bound V_j - V_i <= c to "oct".
+ */
+static void octagon_add_bound(struct isl_octagon *oct, int i, int j, long c)
+{
+	if (c < OCT(oct, i, j))
+		OCT(oct, i, j) = c;
+}
+
+/* Add the constraint sign * (c[0] + sum_k c[1 + k] x_k) >= 0
+ * to "oct", where "c" is known to satisfy is_octagonal_constraint.
+ * Return 1 if the constraint is trivially violated and 0 otherwise.
+ *
+ * A constraint a x_k + c0 >= 0 is turned into the unary constraint
+ * -x_k <= floor(c0/a) if a > 0 and x_k <= floor(c0/-a) if a < 0.
+ * A constraint a x_k + b x_l + c0 >= 0 is turned into
+ * V_P + V_Q <= c0, with V_P = -a x_k and V_Q = -b x_l.
+ */
+static int octagon_add_constraint(struct isl_octagon *oct, isl_int *c,
+	int sign)
+{
+	int pos[2];
+	int P, Q;
+	long c0, a;
+
+	c0 = sign * isl_int_get_si(c[0]);
+	switch (octagon_constraint_vars(c, oct->n / 2, pos)) {
+	case 0:
+		return c0 < 0;
+	case 1:
+		a = sign * isl_int_get_si(c[1 + pos[0]]);
+		if (a > 0) {
+			P = 2 * pos[0] + 1;
+		} else {
+			P = 2 * pos[0];
+			a = -a;
+		}
+		octagon_add_bound(oct, P ^ 1, P, 2 * floor_div(c0, a));
+		return 0;
+	}
+
+	P = 2 * pos[0] + (sign * isl_int_sgn(c[1 + pos[0]]) > 0);
+	Q = 2 * pos[1] + (sign * isl_int_sgn(c[1 + pos[1]]) > 0);
+	octagon_add_bound(oct, Q ^ 1, P, c0);
+	octagon_add_bound(oct, P ^ 1, Q, c0);
+	return 0;
+}
+
+/* Compute the shortest-path closure of "oct" using the Floyd-Warshall
+ * algorithm.
+ * Return 1 if a negative cycle is detected, i.e., if "oct"
+ * does not have any rational solutions, and 0 otherwise.
+ *
+ * The check for negative cycles is performed after each step
+ * to ensure that all finite elements remain bounded by
+ * (twice) the sum of the constant terms along a simple path.
+ */
+static int octagon_close(struct isl_octagon *oct)
+{
+	int i, j, k;
+	int n = oct->n;
+
+	for (k = 0; k < n; ++k) {
+		long *row_k = &OCT(oct, k, 0);
+
+		for (i = 0; i < n; ++i) {
+			long *row_i = &OCT(oct, i, 0);
+			long m_ik = row_i[k];
+
+			if (m_ik == OCT_INF)
+				continue;
+			for (j = 0; j < n; ++j) {
+				if (row_k[j] == OCT_INF)
+					continue;
+				if (m_ik + row_k[j] < row_i[j])
+					row_i[j] = m_ik + row_k[j];
+			}
+		}
+		for (i = 0; i < n; ++i)
+			if (OCT(oct, i, i) < 0)
+				return 1;
+	}
+
+	return 0;
+}
+
+/* Tighten the closed octagon "oct" to its integer points and
+ * propagate the tightened unary constraints.
+ * Return 1 if "oct" has no integer solutions and 0 otherwise.
+ *
+ * This is the tight closure algorithm of Bagnara, Hill and Zaffanella,
+ * "An Improved Tight Closure Algorithm for Integer Octagonal Constraints".
+ * Each unary bound V_i - V_{i^1} <= c is first rounded down
+ * to an even value, after which the octagon has integer solutions
+ * if and only if V_i - V_{i^1} <= c and V_{i^1} - V_i <= d
+ * satisfy c + d >= 0 for each node i.
+ * Finally, each bound V_j - V_i is strengthened to
+ * (V_{i^1} - V_i + V_j - V_{j^1}) / 2.
+ */
+static int octagon_tighten(struct isl_octagon *oct)
+{
+	int i, j;
+	int n = oct->n;
+
+	for (i = 0; i < n; ++i)
+		if (OCT(oct, i, i ^ 1) != OCT_INF)
+			OCT(oct, i, i ^ 1) = 2 * floor_div(OCT(oct, i, i ^ 1), 2);
+	for (i = 0; i < n; i += 2) {
+		if (OCT(oct, i, i + 1) == OCT_INF ||
+		    OCT(oct, i + 1, i) == OCT_INF)
+			continue;
+		if (OCT(oct, i, i + 1) + OCT(oct, i + 1, i) < 0)
+			return 1;
+	}
+	for (i = 0; i < n; ++i) {
+		long m_i = OCT(oct, i, i ^ 1);
+
+		if (m_i == OCT_INF)
+			continue;
+		for (j = 0; j < n; ++j) {
+			long m_j = OCT(oct, j ^ 1, j);
+
+			if (m_j == OCT_INF)
+				continue;
+			octagon_add_bound(oct, i, j, (m_i + m_j) / 2);
+		}
+	}
+
+	return 0;
+}
+
+/* Fix variable "k" of the tightly closed octagon "oct" to "v" and
+ * restore the shortest-path closure.
+ *
+ * This adds the bounds V_{2k} - V_{2k+1} <= 2v and V_{2k+1} - V_{2k} <= -2v.
+ * Since "oct" was closed before, any shortest path that
+ * has become shorter uses exactly one of these two edges.
+ * The old rows and columns of the two nodes are saved in oct->tmp
+ * since they may get updated along the way.
+ */
+static void octagon_fix(struct isl_octagon *oct, int k, long v)
+{
+	int i, j;
+	int n = oct->n;
+	int a = 2 * k + 1, b = 2 * k;
+	long *col_a = oct->tmp, *col_b = oct->tmp + n;
+	long *row_a = oct->tmp + 2 * n, *row_b = oct->tmp + 3 * n;
+
+	for (i = 0; i < n; ++i) {
+		col_a[i] = OCT(oct, i, a);
+		col_b[i] = OCT(oct, i, b);
+		row_a[i] = OCT(oct, a, i);
+		row_b[i] = OCT(oct, b, i);
+	}
+
+	for (i = 0; i < n; ++i) {
+		for (j = 0; j < n; ++j) {
+			if (col_a[i] != OCT_INF && row_b[j] != OCT_INF)
+				octagon_add_bound(oct, i, j,
+						col_a[i] + 2 * v + row_b[j]);
+			if (col_b[i] != OCT_INF && row_a[j] != OCT_INF)
+				octagon_add_bound(oct, i, j,
+						col_b[i] - 2 * v + row_a[j]);
+		}
+	}
+}
+
+/* Construct an integer point in the tightly closed octagon "oct"
+ * over "dim" variables.
+ * Return NULL if the construction fails, which should not happen
+ * since each integer value within the bounds of a variable
+ * of a tightly closed octagon can be extended to a solution.
+ *
+ * The variables are fixed one by one to the value within their bounds
+ * that is closest to zero.  After fixing a variable, the octagon
+ * is closed and tightened again.
+ */
+static __isl_give isl_vec *octagon_sample(isl_ctx *ctx,
+	struct isl_octagon *oct, unsigned dim)
+{
+	int k;
+	isl_vec *sample;
+
+	sample = isl_vec_alloc(ctx, 1 + dim);
+	if (!sample)
+		return NULL;
+	isl_int_set_si(sample->el[0], 1);
+
+	for (k = 0; k < dim; ++k) {
+		long lo = OCT(oct, 2 * k, 2 * k + 1);
+		long hi = OCT(oct, 2 * k + 1, 2 * k);
+		long v = 0;
+
+		if (hi != OCT_INF && v > hi / 2)
+			v = hi / 2;
+		if (lo != OCT_INF && v < -(lo / 2))
+			v = -(lo / 2);
+		isl_int_set_si(sample->el[1 + k], v);
+		octagon_fix(oct, k, v);
+		if (octagon_tighten(oct))
+			isl_die(ctx, isl_error_internal,
+				"unable to construct point in octagon",
+				return isl_vec_free(sample));
+	}
+
+	return sample;
+}
+
+/* Compute an integer sample point in "bset", which is assumed
+ * to satisfy isl_basic_set_is_octagon, without using a tableau.
+ * Return a zero-length vector if "bset" does not contain any integer points.
+ *
+ * The constraints are collected in an octagon, which is then
+ * closed, tightened and used to construct a sample point.
+ * The sample point is checked against the original constraints
+ * as a safety measure.
+ */
+__isl_give isl_vec *isl_basic_set_octagon_sample(
+	__isl_take isl_basic_set *bset)
+{
+	int i;
+	int empty = 0;
+	unsigned dim;
+	isl_ctx *ctx;
+	struct isl_octagon *oct;
+	isl_vec *sample = NULL;
+	isl_bool contains;
+
+	if (!bset)
+		return NULL;
+
+	ctx = isl_basic_set_get_ctx(bset);
+	dim = isl_basic_set_total_dim(bset);
+	oct = octagon_alloc(ctx, dim);
+	if (!oct)
+		goto error;
+
+	for (i = 0; !empty && i < bset->n_eq; ++i) {
+		empty = octagon_add_constraint(oct, bset->eq[i], 1);
+		if (!empty)
+			empty = octagon_add_constraint(oct, bset->eq[i], -1);
+	}
+	for (i = 0; !empty && i < bset->n_ineq; ++i)
+		empty = octagon_add_constraint(oct, bset->ineq[i], 1);
+	if (!empty)
+		empty = octagon_close(oct);
+	if (!empty)
+		empty = octagon_tighten(oct);
+
+	if (empty)
+		sample = isl_vec_alloc(ctx, 0);
+	else
+		sample = octagon_sample(ctx, oct, dim);
+	octagon_free(oct);
+	if (!sample || empty)
+		goto done;
+
+	contains = isl_basic_set_contains(bset, sample);
+	if (contains < 0)
+		sample = isl_vec_free(sample);
+	else if (!contains)
+		isl_die(ctx, isl_error_internal,
+			"point constructed from octagon does not satisfy "
+			"constraints", sample = isl_vec_free(sample));
+done:
+	isl_basic_set_free(bset);
+	return sample;
+error:
+	isl_basic_set_free(bset);
+	return NULL;
+}
@@ -0,0 +1,23 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#ifndef ISL_OCTAGON_H
+#define ISL_OCTAGON_H
+
+#include <isl/set.h>
+#include <isl/vec.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+isl_bool isl_basic_set_is_octagon(__isl_keep isl_basic_set *bset);
+__isl_give isl_vec *isl_basic_set_octagon_sample(
+	__isl_take isl_basic_set *bset);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -117,6 +117,8 @@ ISL_ARG_CHOICE(struct isl_options, gbr, 0, "gbr", \
 ISL_ARG_CHOICE(struct isl_options, closure, 0, "closure", \
 	isl_closure_choice,	ISL_CLOSURE_ISL,
 	"closure operation to use")
+ISL_ARG_BOOL(struct isl_options, closure_cache, 0, "closure-cache", 0,
+	"reuse previously computed transitive closures and powers")
 ISL_ARG_BOOL(struct isl_options, gbr_only_first, 0, "gbr-only-first", 0,
 	"only perform basis reduction in first direction")
 ISL_ARG_CHOICE(struct isl_options, bound, 0, "bound", bound,
@@ -212,10 +214,16 @@ ISL_ARG_BOOL(struct isl_options, ast_build_allow_else, 0,
 	"ast-build-allow-else", 1, "generate if statements with else branches")
 ISL_ARG_BOOL(struct isl_options, ast_build_allow_or, 0,
 	"ast-build-allow-or", 1, "generate if conditions with disjunctions")
+ISL_ARG_BOOL(struct isl_options, ast_build_cache, 0,
+	"ast-build-cache", 0, "reuse ASTs generated for identical "
+	"schedule subtrees in the same AST build")
 ISL_ARG_BOOL(struct isl_options, print_stats, 0, "print-stats", 0,
 	"print statistics for every isl_ctx")
 ISL_ARG_ULONG(struct isl_options, max_operations, 0,
 	"max-operations", 0, "default number of maximal operations per isl_ctx")
+ISL_ARG_ULONG(struct isl_options, max_memory, 0,
+	"max-memory", 0, "default maximal number of bytes of tracked memory "
+	"per isl_ctx")
 ISL_ARG_VERSION(print_version)
 ISL_ARGS_END
 
@@ -236,6 +244,28 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	pip_symmetry)
 
+/* Set the closure_cache option of "ctx" to "val".
+ * If the option is turned off, then the results that have been
+ * cached so far are released as well.
+ */
+isl_stat isl_options_set_closure_cache(isl_ctx *ctx, int val)
+{
+	struct isl_options *options;
+
+	options = isl_ctx_peek_isl_options(ctx);
+	if (!options)
+		isl_die(ctx, isl_error_invalid,
+			"isl_ctx does not reference isl_options",
+			return isl_stat_error);
+	options->closure_cache = val;
+	if (!val)
+		isl_ctx_clear_closure_cache(ctx);
+	return isl_stat_ok;
+}
+
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	closure_cache)
+
 ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	coalesce_bounded_wrapping)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
@@ -375,3 +405,8 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	ast_build_allow_or)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	ast_build_allow_or)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	ast_build_cache)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	ast_build_cache)
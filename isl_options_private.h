@@ -17,6 +17,7 @@ struct isl_options {
 	#define			ISL_CLOSURE_ISL		0
 	#define			ISL_CLOSURE_BOX		1
 	unsigned		closure;
+	int			closure_cache;
 
 	int			bound;
 	unsigned		on_error;
@@ -65,9 +66,11 @@ struct isl_options {
 	int			ast_build_scale_strides;
 	int			ast_build_allow_else;
 	int			ast_build_allow_or;
+	int			ast_build_cache;
 
 	int			print_stats;
 	unsigned long		max_operations;
+	unsigned long		max_memory;
 };
 
 #endif
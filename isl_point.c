@@ -312,6 +312,32 @@ error:
 	return isl_stat_error;
 }
 
+/* Call "fn" on each integer point in chunk "chunk" out of "n_chunk" chunks
+ * of "set".
+ * The chunks partition the integer points of "set" according
+ * to the value of the first set dimension, such that the chunks
+ * can be enumerated independently.
+ */
+isl_stat isl_set_foreach_point_chunk(__isl_keep isl_set *set,
+	int n_chunk, int chunk,
+	isl_stat (*fn)(__isl_take isl_point *pnt, void *user), void *user)
+{
+	struct isl_foreach_point fp = { { &foreach_point }, fn, user };
+	isl_stat r;
+
+	if (!set)
+		return isl_stat_error;
+
+	fp.dim = isl_set_get_space(set);
+	if (!fp.dim)
+		return isl_stat_error;
+
+	r = isl_set_scan_chunk(isl_set_copy(set), n_chunk, chunk, &fp.callback);
+
+	isl_space_free(fp.dim);
+	return r;
+}
+
 /* Return 1 if "bmap" contains the point "point".
  * "bmap" is assumed to have known divs.
  * The point is first extended with the divs and then passed
@@ -9,6 +9,8 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #define ISL_DIM_H
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
@@ -28,6 +30,7 @@
 #include <isl_aff_private.h>
 #include <isl_val_private.h>
 #include <isl_config.h>
+#include <isl/ilp.h>
 
 static unsigned pos(__isl_keep isl_space *dim, enum isl_dim_type type)
 {
@@ -972,6 +975,185 @@ error:
 	return NULL;
 }
 
+/* Is "up" a rational constant, i.e., a constant that is not
+ * NaN or (negative) infinity?
+ */
+static int isl_upoly_is_rat_cst(__isl_keep struct isl_upoly *up)
+{
+	struct isl_upoly_cst *cst;
+
+	if (!isl_upoly_is_cst(up))
+		return 0;
+	cst = isl_upoly_as_cst(up);
+	return !isl_int_is_zero(cst->d);
+}
+
+/* Return the degree of "up" in the variable "var",
+ * where "var" is the top-level variable of "up" or
+ * a variable that is larger than the top-level variable of "up".
+ */
+static int isl_upoly_top_degree(__isl_keep struct isl_upoly *up, int var)
+{
+	struct isl_upoly_rec *rec;
+
+	if (up->var != var)
+		return 0;
+	rec = (struct isl_upoly_rec *) up;
+	return rec->n - 1;
+}
+
+/* Remove the leading zero coefficients of "up" and
+ * replace it by its constant term if it no longer depends
+ * on its top-level variable.
+ */
+static __isl_give struct isl_upoly *isl_upoly_rec_normalize(
+	__isl_take struct isl_upoly *up)
+{
+	struct isl_upoly_rec *rec;
+
+	rec = isl_upoly_as_rec(up);
+	if (!rec)
+		return isl_upoly_free(up);
+	while (rec->n > 0 && isl_upoly_is_zero(rec->p[rec->n - 1])) {
+		isl_upoly_free(rec->p[rec->n - 1]);
+		rec->n--;
+	}
+
+	if (rec->n == 0)
+		up = replace_by_zero(up);
+	else if (rec->n == 1)
+		up = replace_by_constant_term(up);
+
+	return up;
+}
+
+/* Add the product of the rational constants "up1" and "up2"
+ * to the rational constant "acc".
+ */
+static __isl_give struct isl_upoly *isl_upoly_cst_add_mul(
+	__isl_take struct isl_upoly *acc, __isl_keep struct isl_upoly *up1,
+	__isl_keep struct isl_upoly *up2)
+{
+	isl_int t;
+	struct isl_upoly_cst *cst, *cst1, *cst2;
+
+	acc = isl_upoly_cow(acc);
+	if (!acc)
+		return NULL;
+
+	cst = isl_upoly_as_cst(acc);
+	cst1 = isl_upoly_as_cst(up1);
+	cst2 = isl_upoly_as_cst(up2);
+
+	isl_int_init(t);
+	isl_int_mul(t, cst1->n, cst2->n);
+	if (isl_int_is_one(cst1->d) && isl_int_is_one(cst2->d)) {
+		isl_int_addmul(cst->n, cst->d, t);
+	} else {
+		isl_int u;
+
+		isl_int_init(u);
+		isl_int_mul(u, cst1->d, cst2->d);
+		isl_int_mul(cst->n, cst->n, u);
+		isl_int_addmul(cst->n, cst->d, t);
+		isl_int_mul(cst->d, cst->d, u);
+		isl_int_clear(u);
+		isl_upoly_cst_reduce(cst);
+	}
+	isl_int_clear(t);
+
+	return acc;
+}
+
+/* Add the product of "up1" and "up2" to "acc".
+ *
+ * This is equivalent to
+ *
+ *	isl_upoly_sum(acc, isl_upoly_mul(isl_upoly_copy(up1),
+ *						isl_upoly_copy(up2)))
+ *
+ * but avoids constructing the (intermediate) product whenever
+ * "acc" already has room for all the terms in the product.
+ * That is, if "acc" has the same top-level variable as the product,
+ * then the products of the coefficients of "up1" and "up2" are
+ * added to the coefficients of "acc" directly, while if "acc" has
+ * a greater top-level variable, then the product is added
+ * to the constant term of "acc".
+ * In all other cases, including those involving NaN or infinities,
+ * the computation is delegated to isl_upoly_sum and isl_upoly_mul.
+ */
+static __isl_give struct isl_upoly *isl_upoly_add_mul(
+	__isl_take struct isl_upoly *acc, __isl_keep struct isl_upoly *up1,
+	__isl_keep struct isl_upoly *up2)
+{
+	int i, j;
+	int var;
+	struct isl_upoly_rec *rec, *rec1, *rec2;
+
+	if (!acc || !up1 || !up2)
+		return isl_upoly_free(acc);
+	if (isl_upoly_is_zero(up1) || isl_upoly_is_zero(up2))
+		return acc;
+
+	if ((isl_upoly_is_cst(acc) && !isl_upoly_is_rat_cst(acc)) ||
+	    (isl_upoly_is_cst(up1) && !isl_upoly_is_rat_cst(up1)) ||
+	    (isl_upoly_is_cst(up2) && !isl_upoly_is_rat_cst(up2)))
+		goto fallback;
+
+	var = up1->var > up2->var ? up1->var : up2->var;
+	if (acc->var < 0 && var < 0)
+		return isl_upoly_cst_add_mul(acc, up1, up2);
+
+	if (acc->var < var)
+		goto fallback;
+	if (acc->var > var) {
+		acc = isl_upoly_cow(acc);
+		rec = isl_upoly_as_rec(acc);
+		if (!rec)
+			return isl_upoly_free(acc);
+		rec->p[0] = isl_upoly_add_mul(rec->p[0], up1, up2);
+		if (!rec->p[0])
+			return isl_upoly_free(acc);
+		return acc;
+	}
+
+	rec = isl_upoly_as_rec(acc);
+	if (!rec)
+		return isl_upoly_free(acc);
+	if (rec->n <= isl_upoly_top_degree(up1, var) +
+			isl_upoly_top_degree(up2, var))
+		goto fallback;
+
+	acc = isl_upoly_cow(acc);
+	rec = isl_upoly_as_rec(acc);
+	if (!rec)
+		return isl_upoly_free(acc);
+	rec1 = up1->var == var ? (struct isl_upoly_rec *) up1 : NULL;
+	rec2 = up2->var == var ? (struct isl_upoly_rec *) up2 : NULL;
+	for (i = 0; i < (rec1 ? rec1->n : 1); ++i) {
+		struct isl_upoly *c1 = rec1 ? rec1->p[i] : up1;
+		for (j = 0; j < (rec2 ? rec2->n : 1); ++j) {
+			struct isl_upoly *c2 = rec2 ? rec2->p[j] : up2;
+			rec->p[i + j] = isl_upoly_add_mul(rec->p[i + j],
+							c1, c2);
+			if (!rec->p[i + j])
+				return isl_upoly_free(acc);
+		}
+	}
+
+	return isl_upoly_rec_normalize(acc);
+fallback:
+	return isl_upoly_sum(acc,
+		    isl_upoly_mul(isl_upoly_copy(up1), isl_upoly_copy(up2)));
+}
+
+/* Multiply "up1" and "up2", both of which have the same top-level
+ * variable.
+ * The products of pairs of coefficients are accumulated
+ * in the coefficients of the result using isl_upoly_add_mul,
+ * such that the individual products only need to be constructed
+ * the first time a coefficient of the result is updated.
+ */
 __isl_give struct isl_upoly *isl_upoly_mul_rec(__isl_take struct isl_upoly *up1,
 	__isl_take struct isl_upoly *up2)
 {
@@ -1005,10 +1187,8 @@ __isl_give struct isl_upoly *isl_upoly_mul_rec(__isl_take struct isl_upoly *up1,
 	}
 	for (i = 0; i < rec1->n; ++i) {
 		for (j = 1; j < rec2->n; ++j) {
-			struct isl_upoly *up;
-			up = isl_upoly_mul(isl_upoly_copy(rec2->p[j]),
-					    isl_upoly_copy(rec1->p[i]));
-			res->p[i + j] = isl_upoly_sum(res->p[i + j], up);
+			res->p[i + j] = isl_upoly_add_mul(res->p[i + j],
+						    rec2->p[j], rec1->p[i]);
 			if (!res->p[i + j])
 				goto error;
 		}
@@ -5010,3 +5190,760 @@ error:
 	isl_basic_map_free(bmap);
 	return NULL;
 }
+
+/* Upper bound on the absolute value of the intermediate results
+ * that are allowed during native evaluation.
+ * This leaves a factor of two with respect to the largest value
+ * that can be represented in a long to make up for rounding
+ * errors in the computation of the bounds.
+ */
+#define ISL_EVAL_NATIVE_LIMIT	((double) LONG_MAX / 2)
+
+/* A node in a compiled representation of an isl_upoly.
+ * If "var" is negative, then the node represents the constant "cst".
+ * Otherwise, it represents a polynomial in variable "var"
+ * with "n" coefficients, stored in the "n" consecutive nodes
+ * starting at position "first".
+ */
+struct isl_eval_upoly {
+	int var;
+	int n;
+	int first;
+	long cst;
+};
+
+/* A compiled version of a basic set with known local variables.
+ * "div" contains "n_div" rows of size "2 + total" and
+ * "eq" and "ineq" contain "n_eq" and "n_ineq" rows of size "1 + total",
+ * where "total" is the number of set variables plus "n_div".
+ * The layout is the same as that of an isl_basic_set.
+ */
+struct isl_eval_bset {
+	int n_div;
+	int n_eq;
+	int n_ineq;
+	long *div;
+	long *eq;
+	long *ineq;
+};
+
+/* A compiled version of a piece of an isl_pw_qpolynomial.
+ * "lo" and "hi" contain lower and upper bounds on the coordinates
+ * of the points in the domain of the piece, with the parameters first.
+ * A coordinate without a bound that fits in a long
+ * has LONG_MIN or LONG_MAX as bound.
+ * "bset" contains the "n_bset" disjuncts of the domain of the piece.
+ * "div" contains the "n_div" rows of the local variables
+ * of the quasi-polynomial and "node" its compiled representation,
+ * with the root node at position 0.
+ * The coefficients of the quasi-polynomial have been multiplied
+ * by the common denominator of the entire isl_pw_qpolynomial.
+ */
+struct isl_eval_piece {
+	long *lo;
+	long *hi;
+	int n_bset;
+	struct isl_eval_bset *bset;
+	int n_div;
+	long *div;
+	int n_node;
+	struct isl_eval_upoly *node;
+};
+
+/* Data structure for evaluating an isl_pw_qpolynomial "pwqp"
+ * in many integer points.
+ *
+ * "dim" is the dimension of the domain of "pwqp".
+ * "native" is set if all coefficients of "pwqp" could be represented
+ * in a long, in which case the pieces have been compiled into "p".
+ * "den" is the common denominator of all coefficients.
+ * "ext" is scratch space for holding a point followed
+ * by the values of local variables, with the constant 1 in front.
+ * "bound" is scratch space of the same size for bounds on
+ * the absolute values of the elements of "ext".
+ * "last" is the position of the last piece that contained a point.
+ */
+struct isl_eval_pwqp {
+	isl_ctx *ctx;
+	isl_pw_qpolynomial *pwqp;
+
+	int dim;
+	int native;
+	isl_int den;
+
+	int n;
+	struct isl_eval_piece *p;
+
+	int max_div;
+	long *ext;
+	double *bound;
+	int last;
+};
+
+/* Return the number of nodes in a compiled representation of "up".
+ */
+static int upoly_n_node(__isl_keep struct isl_upoly *up)
+{
+	int i, n;
+	struct isl_upoly_rec *rec;
+
+	if (isl_upoly_is_cst(up))
+		return 1;
+	rec = isl_upoly_as_rec(up);
+	n = 1;
+	for (i = 0; i < rec->n; ++i)
+		n += upoly_n_node(rec->p[i]);
+	return n;
+}
+
+/* Compile "up" into node[pos], appending any children of the node
+ * after position "*next" and updating "*next" accordingly.
+ * The constants are multiplied by "den".
+ * Return 0 if all (scaled) constants fit in a long and -1 otherwise.
+ */
+static int upoly_compile(__isl_keep struct isl_upoly *up,
+	struct isl_eval_upoly *node, int pos, int *next, isl_int den)
+{
+	int i;
+	int r = 0;
+	struct isl_upoly_cst *cst;
+	struct isl_upoly_rec *rec;
+
+	if (isl_upoly_is_cst(up)) {
+		isl_int t;
+
+		cst = isl_upoly_as_cst(up);
+		isl_int_init(t);
+		isl_int_divexact(t, den, cst->d);
+		isl_int_mul(t, t, cst->n);
+		if (isl_int_fits_slong(t))
+			node[pos].cst = isl_int_get_si(t);
+		else
+			r = -1;
+		isl_int_clear(t);
+		node[pos].var = -1;
+		return r;
+	}
+
+	rec = isl_upoly_as_rec(up);
+	node[pos].var = up->var;
+	node[pos].n = rec->n;
+	node[pos].first = *next;
+	*next += rec->n;
+	for (i = 0; i < rec->n; ++i)
+		if (upoly_compile(rec->p[i], node, node[pos].first + i,
+					next, den) < 0)
+			return -1;
+	return 0;
+}
+
+/* Copy the "n_row" rows of "n_col" elements in "row" to "dst".
+ * Return 0 if all elements fit in a long and -1 otherwise.
+ */
+static int copy_rows_si(long *dst, isl_int **row, int n_row, int n_col)
+{
+	int i, j;
+
+	for (i = 0; i < n_row; ++i)
+		for (j = 0; j < n_col; ++j) {
+			if (!isl_int_fits_slong(row[i][j]))
+				return -1;
+			dst[i * n_col + j] = isl_int_get_si(row[i][j]);
+		}
+	return 0;
+}
+
+/* Compile the basic set "bset" into "ebset".
+ * Return 1 if this was successful, 0 if some of the coefficients
+ * do not fit in a long or if some of the local variables are unknown and
+ * -1 on error.
+ */
+static int bset_compile(struct isl_eval_bset *ebset,
+	__isl_keep isl_basic_set *bset)
+{
+	int i;
+	isl_ctx *ctx;
+	unsigned total;
+
+	for (i = 0; i < bset->n_div; ++i)
+		if (isl_int_is_zero(bset->div[i][0]))
+			return 0;
+
+	ctx = isl_basic_set_get_ctx(bset);
+	total = isl_basic_set_total_dim(bset);
+	ebset->n_div = bset->n_div;
+	ebset->n_eq = bset->n_eq;
+	ebset->n_ineq = bset->n_ineq;
+	ebset->div = isl_alloc_array(ctx, long, bset->n_div * (2 + total));
+	ebset->eq = isl_alloc_array(ctx, long, bset->n_eq * (1 + total));
+	ebset->ineq = isl_alloc_array(ctx, long, bset->n_ineq * (1 + total));
+	if ((bset->n_div && !ebset->div) || (bset->n_eq && !ebset->eq) ||
+	    (bset->n_ineq && !ebset->ineq))
+		return -1;
+	if (copy_rows_si(ebset->div, bset->div, bset->n_div, 2 + total) < 0 ||
+	    copy_rows_si(ebset->eq, bset->eq, bset->n_eq, 1 + total) < 0 ||
+	    copy_rows_si(ebset->ineq, bset->ineq, bset->n_ineq, 1 + total) < 0)
+		return 0;
+	return 1;
+}
+
+/* Return the value of "v" if it is an integer that fits in a long
+ * and "def" otherwise.  "v" is freed.
+ */
+static long val_get_si_or(__isl_take isl_val *v, long def)
+{
+	long r = def;
+
+	if (v && isl_val_is_int(v) && isl_int_fits_slong(v->n))
+		r = isl_int_get_si(v->n);
+	isl_val_free(v);
+	return r;
+}
+
+/* Compute the bounding box of the domain "set" of a piece
+ * in ep->lo and ep->hi.
+ * The parameters are moved into the set variables such that
+ * the coordinates are ordered in the same way as the points
+ * passed to isl_pw_qpolynomial_eval_batch_si.
+ * The bounds are computed over the integer points in the domain
+ * and are rounded inwards if they are not integral.
+ */
+static isl_stat piece_compute_box(struct isl_eval_pwqp *eval,
+	struct isl_eval_piece *ep, __isl_keep isl_set *set)
+{
+	int i;
+	unsigned nparam;
+	isl_local_space *ls;
+
+	ep->lo = isl_alloc_array(eval->ctx, long, eval->dim);
+	ep->hi = isl_alloc_array(eval->ctx, long, eval->dim);
+	if (eval->dim && (!ep->lo || !ep->hi))
+		return isl_stat_error;
+
+	nparam = isl_set_dim(set, isl_dim_param);
+	set = isl_set_move_dims(isl_set_copy(set), isl_dim_set, 0,
+				isl_dim_param, 0, nparam);
+	ls = isl_local_space_from_space(isl_set_get_space(set));
+	for (i = 0; i < eval->dim; ++i) {
+		isl_aff *obj;
+		isl_val *min, *max;
+
+		obj = isl_aff_var_on_domain(isl_local_space_copy(ls),
+					    isl_dim_set, i);
+		min = isl_set_min_val(set, obj);
+		max = isl_set_max_val(set, obj);
+		isl_aff_free(obj);
+		if (!min || !max) {
+			isl_val_free(min);
+			isl_val_free(max);
+			break;
+		}
+		ep->lo[i] = val_get_si_or(isl_val_ceil(min), LONG_MIN);
+		ep->hi[i] = val_get_si_or(isl_val_floor(max), LONG_MAX);
+	}
+	isl_local_space_free(ls);
+	isl_set_free(set);
+
+	return i < eval->dim ? isl_stat_error : isl_stat_ok;
+}
+
+/* Compile the piece "piece" into "ep", updating eval->max_div.
+ * Return 1 if this was successful, 0 if some of the coefficients
+ * do not fit in a long and -1 on error.
+ *
+ * The local variables of the domain need to be known
+ * in order to be able to evaluate them, so they are computed first.
+ */
+static int piece_compile(struct isl_eval_pwqp *eval, struct isl_eval_piece *ep,
+	struct isl_pw_qpolynomial_piece *piece)
+{
+	int i, r, next;
+	isl_set *set;
+	isl_qpolynomial *qp = piece->qp;
+
+	if (piece_compute_box(eval, ep, piece->set) < 0)
+		return -1;
+	set = isl_set_compute_divs(isl_set_copy(piece->set));
+	if (!set)
+		return -1;
+	ep->bset = isl_calloc_array(eval->ctx, struct isl_eval_bset, set->n);
+	if (set->n && !ep->bset)
+		goto error;
+	ep->n_bset = set->n;
+	for (i = 0; i < set->n; ++i) {
+		isl_basic_set *bset;
+
+		bset = isl_basic_set_copy(set->p[i]);
+		bset = isl_basic_set_order_divs(bset);
+		if (!bset)
+			goto error;
+		if (bset->n_div > eval->max_div)
+			eval->max_div = bset->n_div;
+		r = bset_compile(&ep->bset[i], bset);
+		isl_basic_set_free(bset);
+		if (r <= 0) {
+			isl_set_free(set);
+			return r;
+		}
+	}
+	isl_set_free(set);
+
+	ep->n_div = qp->div->n_row;
+	if (ep->n_div > eval->max_div)
+		eval->max_div = ep->n_div;
+	ep->div = isl_alloc_array(eval->ctx, long, qp->div->n_row *
+						    qp->div->n_col);
+	ep->n_node = upoly_n_node(qp->upoly);
+	ep->node = isl_alloc_array(eval->ctx, struct isl_eval_upoly,
+				    ep->n_node);
+	if ((ep->n_div && !ep->div) || !ep->node)
+		return -1;
+	if (copy_rows_si(ep->div, qp->div->row, qp->div->n_row,
+			qp->div->n_col) < 0)
+		return 0;
+	next = 1;
+	if (upoly_compile(qp->upoly, ep->node, 0, &next, eval->den) < 0)
+		return 0;
+
+	return 1;
+error:
+	isl_set_free(set);
+	return -1;
+}
+
+/* Free all memory allocated by "eval".
+ */
+static void eval_pwqp_clear(struct isl_eval_pwqp *eval)
+{
+	int i, j;
+
+	for (i = 0; eval->p && i < eval->n; ++i) {
+		struct isl_eval_piece *ep = &eval->p[i];
+
+		for (j = 0; ep->bset && j < ep->n_bset; ++j) {
+			free(ep->bset[j].div);
+			free(ep->bset[j].eq);
+			free(ep->bset[j].ineq);
+		}
+		free(ep->lo);
+		free(ep->hi);
+		free(ep->bset);
+		free(ep->div);
+		free(ep->node);
+	}
+	free(eval->p);
+	free(eval->ext);
+	free(eval->bound);
+	isl_int_clear(eval->den);
+}
+
+/* Initialize "eval" for evaluating "pwqp".
+ *
+ * The common denominator of all coefficients of "pwqp" is computed first,
+ * ignoring any infinite or NaN pieces, which have a zero denominator.
+ * If "pwqp" has any such pieces or if any of
+ * the (scaled) coefficients does not fit in a long,
+ * then eval->native is reset and all evaluations are
+ * performed by isl_pw_qpolynomial_eval.
+ */
+static isl_stat eval_pwqp_init(struct isl_eval_pwqp *eval,
+	__isl_keep isl_pw_qpolynomial *pwqp)
+{
+	int i, r;
+	isl_int d;
+
+	eval->ctx = isl_pw_qpolynomial_get_ctx(pwqp);
+	eval->pwqp = pwqp;
+	eval->dim = isl_space_dim(pwqp->dim, isl_dim_param) +
+		    isl_space_dim(pwqp->dim, isl_dim_in);
+	eval->native = 1;
+	eval->n = 0;
+	eval->p = NULL;
+	eval->max_div = 0;
+	eval->ext = NULL;
+	eval->bound = NULL;
+	eval->last = 0;
+	isl_int_init(eval->den);
+	isl_int_set_si(eval->den, 1);
+
+	isl_int_init(d);
+	for (i = 0; i < pwqp->n; ++i) {
+		isl_qpolynomial_get_den(pwqp->p[i].qp, &d);
+		if (isl_int_is_zero(d))
+			eval->native = 0;
+		else
+			isl_int_lcm(eval->den, eval->den, d);
+	}
+	isl_int_clear(d);
+	if (!eval->native)
+		return isl_stat_ok;
+	if (!isl_int_fits_slong(eval->den)) {
+		eval->native = 0;
+		return isl_stat_ok;
+	}
+
+	eval->p = isl_calloc_array(eval->ctx, struct isl_eval_piece, pwqp->n);
+	if (pwqp->n && !eval->p)
+		return isl_stat_error;
+	eval->n = pwqp->n;
+	for (i = 0; i < pwqp->n; ++i) {
+		r = piece_compile(eval, &eval->p[i], &pwqp->p[i]);
+		if (r < 0)
+			return isl_stat_error;
+		if (!r) {
+			eval->native = 0;
+			return isl_stat_ok;
+		}
+	}
+
+	eval->ext = isl_alloc_array(eval->ctx, long,
+					1 + eval->dim + eval->max_div);
+	eval->bound = isl_alloc_array(eval->ctx, double,
+					1 + eval->dim + eval->max_div);
+	if (!eval->ext || !eval->bound)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Return the absolute value of "v" as a double.
+ */
+static double abs_si(long v)
+{
+	return v < 0 ? -(double) v : (double) v;
+}
+
+/* Return an upper bound on the absolute value of the inner product
+ * of the "n" elements of "row" and a vector with elements bounded by "bound",
+ * assuming it is not larger than ISL_EVAL_NATIVE_LIMIT.
+ * Return -1 if no such bound can be found.
+ */
+static double bound_inner_product(long *row, double *bound, int n)
+{
+	int i;
+	double b = 0;
+
+	for (i = 0; i < n; ++i)
+		b += abs_si(row[i]) * bound[i];
+	return b <= ISL_EVAL_NATIVE_LIMIT ? b : -1;
+}
+
+/* Update bound[1 + dim + i] for each of the "n_div" local variables
+ * defined by the rows in "div", assuming the remaining elements
+ * of "bound" have already been set.
+ * Return 0 if all intermediate results of the computation
+ * of the local variables can be computed in a long and -1 otherwise.
+ */
+static int bound_divs(long *div, int n_div, int dim, double *bound)
+{
+	int i;
+	double b;
+
+	for (i = 0; i < n_div; ++i) {
+		long *row = div + i * (2 + dim + n_div);
+
+		b = bound_inner_product(row + 1, bound, 1 + dim + i);
+		if (b < 0)
+			return -1;
+		bound[1 + dim + i] = b / abs_si(row[0]) + 1;
+	}
+
+	return 0;
+}
+
+/* Return an upper bound on the absolute value of any intermediate
+ * result in the evaluation of node[pos], given bounds on
+ * the absolute values of the variables in "bound".
+ * Return -1 if this bound is larger than ISL_EVAL_NATIVE_LIMIT.
+ */
+static double bound_upoly(struct isl_eval_upoly *node, int pos, double *bound)
+{
+	int i;
+	double b, c;
+	struct isl_eval_upoly *up = &node[pos];
+
+	if (up->var < 0)
+		return abs_si(up->cst);
+
+	b = bound_upoly(node, up->first + up->n - 1, bound);
+	for (i = up->n - 2; b >= 0 && i >= 0; --i) {
+		c = bound_upoly(node, up->first + i, bound);
+		if (c < 0)
+			return -1;
+		b = b * bound[1 + up->var] + c;
+		if (b > ISL_EVAL_NATIVE_LIMIT)
+			return -1;
+	}
+
+	return b;
+}
+
+/* Can all points with coordinates bounded by "max" in absolute value
+ * be evaluated using native integer arithmetic?
+ * That is, are all intermediate results in the evaluation of
+ * the local variables, the constraints and the quasi-polynomials
+ * guaranteed to fit in a long?
+ */
+static int eval_pwqp_native_safe(struct isl_eval_pwqp *eval, double max)
+{
+	int i, j, k;
+
+	if (!eval->native)
+		return 0;
+
+	eval->bound[0] = 1;
+	for (i = 0; i < eval->dim; ++i)
+		eval->bound[1 + i] = max;
+
+	for (i = 0; i < eval->n; ++i) {
+		struct isl_eval_piece *ep = &eval->p[i];
+
+		for (j = 0; j < ep->n_bset; ++j) {
+			struct isl_eval_bset *eb = &ep->bset[j];
+			int total = eval->dim + eb->n_div;
+
+			if (bound_divs(eb->div, eb->n_div, eval->dim,
+					eval->bound) < 0)
+				return 0;
+			for (k = 0; k < eb->n_eq; ++k)
+				if (bound_inner_product(eb->eq + k * (1 + total),
+						eval->bound, 1 + total) < 0)
+					return 0;
+			for (k = 0; k < eb->n_ineq; ++k)
+				if (bound_inner_product(
+					    eb->ineq + k * (1 + total),
+					    eval->bound, 1 + total) < 0)
+					return 0;
+		}
+		if (bound_divs(ep->div, ep->n_div, eval->dim, eval->bound) < 0)
+			return 0;
+		if (bound_upoly(ep->node, 0, eval->bound) < 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+/* Return the inner product of the "n" elements of "row" and "ext".
+ */
+static long inner_product_si(long *row, long *ext, int n)
+{
+	int i;
+	long v = 0;
+
+	for (i = 0; i < n; ++i)
+		v += row[i] * ext[i];
+	return v;
+}
+
+/* Compute the values of the "n_div" local variables defined by "div"
+ * and store them in ext[1 + dim + i].
+ * The denominators of the local variables are positive.
+ */
+static void eval_divs_si(long *div, int n_div, int dim, long *ext)
+{
+	int i;
+
+	for (i = 0; i < n_div; ++i) {
+		long *row = div + i * (2 + dim + n_div);
+		long v = inner_product_si(row + 1, ext, 1 + dim + i);
+		long q = v / row[0];
+
+		if (v % row[0] != 0 && v < 0)
+			q--;
+		ext[1 + dim + i] = q;
+	}
+}
+
+/* Does the point in "ext" belong to the compiled basic set "eb"?
+ */
+static int bset_contains_si(struct isl_eval_bset *eb, int dim, long *ext)
+{
+	int k;
+	int total = dim + eb->n_div;
+
+	eval_divs_si(eb->div, eb->n_div, dim, ext);
+	for (k = 0; k < eb->n_eq; ++k)
+		if (inner_product_si(eb->eq + k * (1 + total), ext,
+					1 + total) != 0)
+			return 0;
+	for (k = 0; k < eb->n_ineq; ++k)
+		if (inner_product_si(eb->ineq + k * (1 + total), ext,
+					1 + total) < 0)
+			return 0;
+	return 1;
+}
+
+/* Does the point in "ext" belong to the domain of the compiled piece "ep"?
+ *
+ * Points outside the bounding box of the domain are rejected
+ * before any of the local variables or constraints are evaluated.
+ */
+static int piece_contains_si(struct isl_eval_piece *ep, int dim, long *ext)
+{
+	int j;
+
+	for (j = 0; j < dim; ++j)
+		if (ext[1 + j] < ep->lo[j] || ext[1 + j] > ep->hi[j])
+			return 0;
+	for (j = 0; j < ep->n_bset; ++j)
+		if (bset_contains_si(&ep->bset[j], dim, ext))
+			return 1;
+	return 0;
+}
+
+/* Evaluate node[pos] in "ext" using Horner's rule.
+ */
+static long upoly_eval_si(struct isl_eval_upoly *node, int pos, long *ext)
+{
+	int i;
+	long v;
+	struct isl_eval_upoly *up = &node[pos];
+
+	if (up->var < 0)
+		return up->cst;
+
+	v = upoly_eval_si(node, up->first + up->n - 1, ext);
+	for (i = up->n - 2; i >= 0; --i) {
+		v *= ext[1 + up->var];
+		v += upoly_eval_si(node, up->first + i, ext);
+	}
+
+	return v;
+}
+
+/* Evaluate the compiled isl_pw_qpolynomial in the point "pnt"
+ * using native integer arithmetic and return the value
+ * multiplied by eval->den.
+ *
+ * The pieces are scanned linearly, starting from the piece
+ * that contained the previous point since consecutive points
+ * often lie in the same piece.  Most other pieces are typically
+ * rejected by piece_contains_si based on their bounding boxes.
+ */
+static long eval_pwqp_point_si(struct isl_eval_pwqp *eval, const long *pnt)
+{
+	int i, k;
+
+	eval->ext[0] = 1;
+	for (i = 0; i < eval->dim; ++i)
+		eval->ext[1 + i] = pnt[i];
+
+	for (k = 0; k < eval->n; ++k) {
+		struct isl_eval_piece *ep;
+
+		i = (eval->last + k) % eval->n;
+		ep = &eval->p[i];
+		if (!piece_contains_si(ep, eval->dim, eval->ext))
+			continue;
+		eval->last = i;
+		eval_divs_si(ep->div, ep->n_div, eval->dim, eval->ext);
+		return upoly_eval_si(ep->node, 0, eval->ext);
+	}
+
+	return 0;
+}
+
+/* Evaluate the isl_pw_qpolynomial in the point "pnt" using
+ * isl_pw_qpolynomial_eval and store the value multiplied
+ * by eval->den in "num".
+ */
+static isl_stat eval_pwqp_point_exact(struct isl_eval_pwqp *eval,
+	const long *pnt, long *num)
+{
+	int i;
+	isl_vec *vec;
+	isl_val *v;
+	isl_point *point;
+
+	vec = isl_vec_alloc(eval->ctx, 1 + eval->dim);
+	if (!vec)
+		return isl_stat_error;
+	isl_int_set_si(vec->el[0], 1);
+	for (i = 0; i < eval->dim; ++i)
+		isl_int_set_si(vec->el[1 + i], pnt[i]);
+	point = isl_point_alloc(isl_pw_qpolynomial_get_domain_space(eval->pwqp),
+				vec);
+	v = isl_pw_qpolynomial_eval(isl_pw_qpolynomial_copy(eval->pwqp),
+				    point);
+	if (!v)
+		return isl_stat_error;
+	if (!isl_val_is_rat(v)) {
+		isl_val_free(v);
+		isl_die(eval->ctx, isl_error_invalid,
+			"value is not rational", return isl_stat_error);
+	}
+	isl_int_mul(v->n, v->n, eval->den);
+	isl_int_divexact(v->n, v->n, v->d);
+	if (!isl_int_fits_slong(v->n)) {
+		isl_val_free(v);
+		isl_die(eval->ctx, isl_error_invalid,
+			"value does not fit in a long",
+			return isl_stat_error);
+	}
+	*num = isl_int_get_si(v->n);
+	isl_val_free(v);
+
+	return isl_stat_ok;
+}
+
+/* Evaluate "pwqp" in the "n" integer points stored in "points".
+ * Each point is represented by the values of the parameters
+ * followed by the values of the set variables of the domain of "pwqp".
+ * The value in point i is stored as num[i] / *den, where *den
+ * is a common denominator of all coefficients of "pwqp".
+ *
+ * The pieces of "pwqp" are first compiled into a representation
+ * that can be evaluated using native integer arithmetic,
+ * along with the bounding boxes of their domains.
+ * If it can be shown from the largest absolute value of any coordinate
+ * in "points" that none of the intermediate results overflows,
+ * then all points are evaluated in this representation.
+ * Otherwise, each point is evaluated using isl_pw_qpolynomial_eval.
+ */
+isl_stat isl_pw_qpolynomial_eval_batch_si(__isl_keep isl_pw_qpolynomial *pwqp,
+	int n, const long *points, long *num, long *den)
+{
+	int i;
+	size_t j, total;
+	double max = 0;
+	const long *pnt;
+	struct isl_eval_pwqp eval;
+
+	if (!pwqp)
+		return isl_stat_error;
+	if (n < 0 || (n > 0 && (!points || !num)) || !den)
+		isl_die(isl_pw_qpolynomial_get_ctx(pwqp), isl_error_invalid,
+			"invalid arguments", return isl_stat_error);
+
+	if (eval_pwqp_init(&eval, pwqp) < 0)
+		goto error;
+	if (!isl_int_fits_slong(eval.den))
+		isl_die(eval.ctx, isl_error_invalid,
+			"denominator does not fit in a long", goto error);
+	*den = isl_int_get_si(eval.den);
+
+	if (eval.dim != 0 && (size_t) n > SIZE_MAX / eval.dim)
+		isl_die(eval.ctx, isl_error_invalid,
+			"too many points", goto error);
+	total = (size_t) n * eval.dim;
+	for (j = 0; j < total; ++j)
+		if (abs_si(points[j]) > max)
+			max = abs_si(points[j]);
+
+	pnt = points;
+	if (eval_pwqp_native_safe(&eval, max)) {
+		for (i = 0; i < n; ++i, pnt += eval.dim)
+			num[i] = eval_pwqp_point_si(&eval, pnt);
+	} else {
+		for (i = 0; i < n; ++i, pnt += eval.dim)
+			if (eval_pwqp_point_exact(&eval, pnt, &num[i]) < 0)
+				goto error;
+	}
+
+	eval_pwqp_clear(&eval);
+	return isl_stat_ok;
+error:
+	eval_pwqp_clear(&eval);
+	return isl_stat_error;
+}
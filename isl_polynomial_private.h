@@ -188,6 +188,11 @@ __isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_fold_on_domain(
 	__isl_keep isl_set *set,
 	__isl_take isl_qpolynomial_fold *fold1,
 	__isl_take isl_qpolynomial_fold *fold2);
+struct isl_tab;
+__isl_give isl_qpolynomial_fold *isl_qpolynomial_fold_fold_on_domain_tab(
+	__isl_keep isl_set *set, struct isl_tab *tab,
+	__isl_take isl_qpolynomial_fold *fold1,
+	__isl_take isl_qpolynomial_fold *fold2);
 
 int isl_qpolynomial_fold_plain_cmp(__isl_keep isl_qpolynomial_fold *fold1,
 	__isl_keep isl_qpolynomial_fold *fold2);
@@ -260,6 +265,19 @@ __isl_give isl_pw_qpolynomial_fold *isl_pw_qpolynomial_fold_mul_isl_int(
 	__isl_take isl_pw_qpolynomial_fold *pwf, isl_int v);
 __isl_give isl_union_pw_qpolynomial *isl_union_pw_qpolynomial_mul_isl_int(
 	__isl_take isl_union_pw_qpolynomial *upwqp, isl_int v);
+
+isl_bool isl_pw_qpolynomial_plain_is_identical(
+	__isl_keep isl_pw_qpolynomial *pwqp1,
+	__isl_keep isl_pw_qpolynomial *pwqp2);
+isl_bool isl_pw_qpolynomial_fold_plain_is_identical(
+	__isl_keep isl_pw_qpolynomial_fold *pwf1,
+	__isl_keep isl_pw_qpolynomial_fold *pwf2);
+isl_bool isl_union_pw_qpolynomial_plain_is_identical(
+	__isl_keep isl_union_pw_qpolynomial *upwqp1,
+	__isl_keep isl_union_pw_qpolynomial *upwqp2);
+isl_bool isl_union_pw_qpolynomial_fold_plain_is_identical(
+	__isl_keep isl_union_pw_qpolynomial_fold *upwf1,
+	__isl_keep isl_union_pw_qpolynomial_fold *upwf2);
 __isl_give isl_union_pw_qpolynomial_fold *
 isl_union_pw_qpolynomial_fold_mul_isl_int(
 	__isl_take isl_union_pw_qpolynomial_fold *upwf, isl_int v);
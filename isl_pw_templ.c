@@ -14,6 +14,7 @@
 #include <isl/aff.h>
 #include <isl_sort.h>
 #include <isl_val_private.h>
+#include <isl_lp_private.h>
 
 #include <isl_pw_macro.h>
 
@@ -397,13 +398,106 @@ error:
 }
 #endif
 
+/* Free the array "boxes" of "n" bounding boxes and return NULL.
+ */
+static struct isl_set_box **FN(PW,free_domain_boxes)(
+	struct isl_set_box **boxes, int n)
+{
+	int i;
+
+	if (!boxes)
+		return NULL;
+	for (i = 0; i < n; ++i)
+		isl_set_box_free(boxes[i]);
+	free(boxes);
+	return NULL;
+}
+
+/* Return an array with a bounding box for the domain of each piece of "pw".
+ */
+static struct isl_set_box **FN(PW,domain_boxes)(__isl_keep PW *pw)
+{
+	int i;
+	isl_ctx *ctx;
+	struct isl_set_box **boxes;
+
+	if (!pw)
+		return NULL;
+	ctx = FN(PW,get_ctx)(pw);
+	boxes = isl_calloc_array(ctx, struct isl_set_box *, pw->n);
+	if (!boxes)
+		return NULL;
+	for (i = 0; i < pw->n; ++i) {
+		boxes[i] = isl_set_box_compute(pw->p[i].set);
+		if (!boxes[i])
+			return FN(PW,free_domain_boxes)(boxes, pw->n);
+	}
+
+	return boxes;
+}
+
+/* Compute bounding boxes of the domains of the pieces of "pw1" and "pw2"
+ * in "boxes1" and "boxes2", if this is deemed worthwhile.
+ * Otherwise, set "boxes1" and "boxes2" to NULL.
+ *
+ * Operations that consider all pairs of pieces of "pw1" and "pw2"
+ * can use these boxes to quickly skip pairs of pieces
+ * with disjoint domains.
+ * Computing the boxes requires a couple of LPs for each piece,
+ * so they are only computed if the number of pairs is large
+ * compared to the number of pieces.
+ */
+static isl_stat FN(PW,pair_domain_boxes)(__isl_keep PW *pw1,
+	__isl_keep PW *pw2, struct isl_set_box ***boxes1,
+	struct isl_set_box ***boxes2)
+{
+	*boxes1 = NULL;
+	*boxes2 = NULL;
+	if (!pw1 || !pw2)
+		return isl_stat_error;
+	if (pw1->n * pw2->n < 2 * (pw1->n + pw2->n))
+		return isl_stat_ok;
+	*boxes1 = FN(PW,domain_boxes)(pw1);
+	*boxes2 = FN(PW,domain_boxes)(pw2);
+	if (*boxes1 && *boxes2)
+		return isl_stat_ok;
+	*boxes1 = FN(PW,free_domain_boxes)(*boxes1, pw1->n);
+	*boxes2 = FN(PW,free_domain_boxes)(*boxes2, pw2->n);
+	return isl_stat_error;
+}
+
+/* Are the domains of piece "i" of a piecewise expression with
+ * bounding boxes "boxes1" and piece "j" of a piecewise expression
+ * with bounding boxes "boxes2" known to be disjoint
+ * based on these bounding boxes?
+ * If no bounding boxes were computed, then nothing is known.
+ */
+static isl_bool FN(PW,domain_boxes_are_disjoint)(struct isl_set_box **boxes1,
+	int i, struct isl_set_box **boxes2, int j)
+{
+	if (!boxes1 || !boxes2)
+		return isl_bool_false;
+	return isl_set_box_is_disjoint(boxes1[i], boxes2[j]);
+}
+
+/* Return the union of the domains of the pieces of "pw1" and "pw2",
+ * where the pieces of "pw2" are added to the piece of "pw1" with
+ * the sum of the two on their shared domains.
+ *
+ * Pairs of pieces with disjoint bounding boxes
+ * (if computed by FN(PW,pair_domain_boxes)) are skipped.
+ * The domains of the pieces of one input that (may) overlap
+ * with a given piece of the other input are collected
+ * and subtracted from the domain of that piece in one go.
+ */
 static __isl_give PW *FN(PW,union_add_aligned)(__isl_take PW *pw1,
 	__isl_take PW *pw2)
 {
 	int i, j, n;
 	struct PW *res;
 	isl_ctx *ctx;
-	isl_set *set;
+	isl_set *set, *sub;
+	struct isl_set_box **boxes1, **boxes2;
 
 	if (!pw1 || !pw2)
 		goto error;
@@ -433,18 +527,29 @@ static __isl_give PW *FN(PW,union_add_aligned)(__isl_take PW *pw1,
 	res = FN(PW,alloc_size)(isl_space_copy(pw1->dim), n);
 #endif
 
-	for (i = 0; i < pw1->n; ++i) {
-		set = isl_set_copy(pw1->p[i].set);
+	if (FN(PW,pair_domain_boxes)(pw1, pw2, &boxes1, &boxes2) < 0)
+		res = FN(PW,free)(res);
+
+	for (i = 0; res && i < pw1->n; ++i) {
+		sub = isl_set_empty(isl_set_get_space(pw1->p[i].set));
 		for (j = 0; j < pw2->n; ++j) {
 			struct isl_set *common;
 			EL *sum;
+			isl_bool disjoint;
+
+			disjoint = FN(PW,domain_boxes_are_disjoint)(boxes1, i,
+								boxes2, j);
+			if (disjoint < 0)
+				res = FN(PW,free)(res);
+			if (disjoint)
+				continue;
 			common = isl_set_intersect(isl_set_copy(pw1->p[i].set),
 						isl_set_copy(pw2->p[j].set));
 			if (isl_set_plain_is_empty(common)) {
 				isl_set_free(common);
 				continue;
 			}
-			set = isl_set_subtract(set,
+			sub = isl_set_union_disjoint(sub,
 					isl_set_copy(pw2->p[j].set));
 
 			sum = FN(EL,add_on_domain)(common,
@@ -453,17 +558,30 @@ static __isl_give PW *FN(PW,union_add_aligned)(__isl_take PW *pw1,
 
 			res = FN(PW,add_piece)(res, common, sum);
 		}
+		set = isl_set_subtract(isl_set_copy(pw1->p[i].set), sub);
 		res = FN(PW,add_piece)(res, set, FN(EL,copy)(pw1->p[i].FIELD));
 	}
 
-	for (j = 0; j < pw2->n; ++j) {
-		set = isl_set_copy(pw2->p[j].set);
-		for (i = 0; i < pw1->n; ++i)
-			set = isl_set_subtract(set,
+	for (j = 0; res && j < pw2->n; ++j) {
+		sub = isl_set_empty(isl_set_get_space(pw2->p[j].set));
+		for (i = 0; i < pw1->n; ++i) {
+			isl_bool disjoint;
+
+			disjoint = FN(PW,domain_boxes_are_disjoint)(boxes1, i,
+								boxes2, j);
+			if (disjoint < 0)
+				res = FN(PW,free)(res);
+			if (disjoint)
+				continue;
+			sub = isl_set_union_disjoint(sub,
 					isl_set_copy(pw1->p[i].set));
+		}
+		set = isl_set_subtract(isl_set_copy(pw2->p[j].set), sub);
 		res = FN(PW,add_piece)(res, set, FN(EL,copy)(pw2->p[j].FIELD));
 	}
 
+	FN(PW,free_domain_boxes)(boxes1, pw1->n);
+	FN(PW,free_domain_boxes)(boxes2, pw2->n);
 	FN(PW,free)(pw1);
 	FN(PW,free)(pw2);
 
@@ -585,6 +703,9 @@ static __isl_give PW *FN(PW,on_shared_domain_in)(__isl_take PW *pw1,
 
 /* Apply "fn" to pairs of elements from pw1 and pw2 on shared domains.
  * The result of "fn" (and therefore also of this function) lives in "space".
+ *
+ * Pairs of pieces with disjoint bounding boxes
+ * (if computed by FN(PW,pair_domain_boxes)) are skipped.
  */
 static __isl_give PW *FN(PW,on_shared_domain_in)(__isl_take PW *pw1,
 	__isl_take PW *pw2, __isl_take isl_space *space,
@@ -592,6 +713,7 @@ static __isl_give PW *FN(PW,on_shared_domain_in)(__isl_take PW *pw1,
 {
 	int i, j, n;
 	PW *res = NULL;
+	struct isl_set_box **boxes1 = NULL, **boxes2 = NULL;
 
 	if (!pw1 || !pw2)
 		goto error;
@@ -602,13 +724,22 @@ static __isl_give PW *FN(PW,on_shared_domain_in)(__isl_take PW *pw1,
 #else
 	res = FN(PW,alloc_size)(isl_space_copy(space), n);
 #endif
+	if (FN(PW,pair_domain_boxes)(pw1, pw2, &boxes1, &boxes2) < 0)
+		goto error;
 
 	for (i = 0; i < pw1->n; ++i) {
 		for (j = 0; j < pw2->n; ++j) {
 			isl_set *common;
 			EL *res_ij;
 			int empty;
+			isl_bool disjoint;
 
+			disjoint = FN(PW,domain_boxes_are_disjoint)(boxes1, i,
+								boxes2, j);
+			if (disjoint < 0)
+				goto error;
+			if (disjoint)
+				continue;
 			common = isl_set_intersect(
 					isl_set_copy(pw1->p[i].set),
 					isl_set_copy(pw2->p[j].set));
@@ -628,11 +759,17 @@ static __isl_give PW *FN(PW,on_shared_domain_in)(__isl_take PW *pw1,
 		}
 	}
 
+	FN(PW,free_domain_boxes)(boxes1, pw1->n);
+	FN(PW,free_domain_boxes)(boxes2, pw2->n);
 	isl_space_free(space);
 	FN(PW,free)(pw1);
 	FN(PW,free)(pw2);
 	return res;
 error:
+	if (pw1)
+		FN(PW,free_domain_boxes)(boxes1, pw1->n);
+	if (pw2)
+		FN(PW,free_domain_boxes)(boxes2, pw2->n);
 	isl_space_free(space);
 	FN(PW,free)(pw1);
 	FN(PW,free)(pw2);
@@ -2018,6 +2155,41 @@ __isl_give PW *FN(PW,normalize)(__isl_take PW *pw)
  * not to be the same.  A NaN is not equal to anything, not even
  * to another NaN.
  */
+/* Are "pw1" and "pw2" represented in exactly the same way?
+ * That is, do they have the same space and the same pieces,
+ * in the same order, with domains that are represented in exactly
+ * the same way and base expressions that are obviously equal?
+ * Unlike PW,plain_is_equal, this function does not normalize its inputs,
+ * so it does not modify their internal representation.
+ */
+isl_bool FN(PW,plain_is_identical)(__isl_keep PW *pw1, __isl_keep PW *pw2)
+{
+	int i;
+	isl_bool equal;
+
+	if (!pw1 || !pw2)
+		return isl_bool_error;
+	if (pw1 == pw2)
+		return isl_bool_true;
+	equal = isl_space_is_equal(pw1->dim, pw2->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	if (pw1->n != pw2->n)
+		return isl_bool_false;
+	for (i = 0; i < pw1->n; ++i) {
+		equal = isl_set_plain_is_identical(pw1->p[i].set,
+						pw2->p[i].set);
+		if (equal < 0 || !equal)
+			return equal;
+		equal = FN(EL,plain_is_equal)(pw1->p[i].FIELD,
+						pw2->p[i].FIELD);
+		if (equal < 0 || !equal)
+			return equal;
+	}
+
+	return isl_bool_true;
+}
+
 isl_bool FN(PW,plain_is_equal)(__isl_keep PW *pw1, __isl_keep PW *pw2)
 {
 	int i;
@@ -178,6 +178,9 @@ error:
  * they are combined into a single piece in the result.
  * In order to be able to do this efficiently, the pieces of "pw1" and
  * "pw2" are first sorted according to their function value expressions.
+ * Pairs of pieces with disjoint bounding boxes
+ * (if computed by FN(PW,pair_domain_boxes)) are skipped
+ * without performing a full disjointness test.
  */
 static __isl_give PW *FN(PW,union_opt_cmp)(
 	__isl_take PW *pw1, __isl_take PW *pw2,
@@ -188,6 +191,7 @@ static __isl_give PW *FN(PW,union_opt_cmp)(
 	isl_ctx *ctx;
 	isl_set *set = NULL;
 	isl_set_list *list1 = NULL, *list2 = NULL;
+	struct isl_set_box **boxes1 = NULL, **boxes2 = NULL;
 
 	if (!pw1 || !pw2)
 		goto error;
@@ -214,14 +218,19 @@ static __isl_give PW *FN(PW,union_opt_cmp)(
 
 	list1 = FN(PW,extract_domains)(pw1);
 	list2 = FN(PW,extract_domains)(pw2);
+	if (FN(PW,pair_domain_boxes)(pw1, pw2, &boxes1, &boxes2) < 0)
+		goto error;
 
 	for (i = 0; i < pw1->n; ++i) {
 		for (j = 0; j < pw2->n; ++j) {
 			isl_bool disjoint;
 			isl_set *better, *set_i, *set_j;
 
-			disjoint = isl_set_is_disjoint(pw1->p[i].set,
-							pw2->p[j].set);
+			disjoint = FN(PW,domain_boxes_are_disjoint)(boxes1, i,
+								boxes2, j);
+			if (disjoint == isl_bool_false)
+				disjoint = isl_set_is_disjoint(pw1->p[i].set,
+								pw2->p[j].set);
 			if (disjoint < 0)
 				goto error;
 			if (disjoint)
@@ -240,10 +249,16 @@ static __isl_give PW *FN(PW,union_opt_cmp)(
 		}
 	}
 
+	FN(PW,free_domain_boxes)(boxes1, pw1->n);
+	FN(PW,free_domain_boxes)(boxes2, pw2->n);
 	res = FN(PW,merge)(pw1, pw2, list1, list2);
 
 	return res;
 error:
+	if (pw1)
+		FN(PW,free_domain_boxes)(boxes1, pw1->n);
+	if (pw2)
+		FN(PW,free_domain_boxes)(boxes2, pw2->n);
 	isl_set_list_free(list1);
 	isl_set_list_free(list2);
 	FN(PW,free)(pw1);
@@ -17,6 +17,7 @@
 #include "isl_tab.h"
 #include "isl_basis_reduction.h"
 #include <isl_factorization.h>
+#include "isl_octagon.h"
 #include <isl_point_private.h>
 #include <isl_options_private.h>
 #include <isl_vec_private.h>
@@ -1151,6 +1152,14 @@ static __isl_give isl_vec *basic_set_sample(__isl_take isl_basic_set *bset,
 	isl_vec_free(bset->sample);
 	bset->sample = NULL;
 
+	if (dim >= 2) {
+		isl_bool octagon = isl_basic_set_is_octagon(bset);
+		if (octagon < 0)
+			goto error;
+		if (octagon)
+			return isl_basic_set_octagon_sample(bset);
+	}
+
 	if (bset->n_eq > 0)
 		return sample_eq(bset, bounded ? isl_basic_set_sample_bounded
 					       : isl_basic_set_sample_vec);
@@ -9,6 +9,8 @@
 
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
+#include <isl/aff.h>
+#include <isl/ilp.h>
 #include "isl_basis_reduction.h"
 #include "isl_scan.h"
 #include <isl_seq.h>
@@ -246,6 +248,107 @@ error:
 	return isl_stat_error;
 }
 
+/* Return the offset of chunk "chunk" out of "n_chunk" chunks
+ * within a range of length "len", i.e., floor(len * chunk / n_chunk).
+ */
+static __isl_give isl_val *chunk_offset(__isl_keep isl_val *len,
+	int n_chunk, int chunk)
+{
+	isl_val *offset;
+
+	offset = isl_val_mul_ui(isl_val_copy(len), chunk);
+	offset = isl_val_div(offset,
+			isl_val_int_from_si(isl_val_get_ctx(len), n_chunk));
+	return isl_val_floor(offset);
+}
+
+/* Restrict "set" to chunk "chunk" out of "n_chunk" chunks.
+ *
+ * The chunks are obtained by splitting the range of values
+ * attained by the first set dimension into "n_chunk" consecutive
+ * intervals of (almost) equal length.
+ * Every integer point of "set" therefore belongs to exactly one chunk.
+ * If "set" has no set dimensions, then all its points
+ * belong to the first chunk.
+ */
+static __isl_give isl_set *set_chunk(__isl_take isl_set *set,
+	int n_chunk, int chunk)
+{
+	isl_ctx *ctx;
+	isl_aff *obj;
+	isl_val *min, *max, *len, *lower, *upper;
+
+	if (!set)
+		return NULL;
+
+	ctx = isl_set_get_ctx(set);
+	if (n_chunk < 1 || chunk < 0 || chunk >= n_chunk)
+		isl_die(ctx, isl_error_invalid, "chunk out of range",
+			return isl_set_free(set));
+	if (n_chunk == 1)
+		return set;
+	if (isl_set_dim(set, isl_dim_set) == 0) {
+		isl_space *space;
+
+		if (chunk == 0)
+			return set;
+		space = isl_set_get_space(set);
+		isl_set_free(set);
+		return isl_set_empty(space);
+	}
+
+	obj = isl_aff_var_on_domain(
+			isl_local_space_from_space(isl_set_get_space(set)),
+			isl_dim_set, 0);
+	min = isl_set_min_val(set, obj);
+	max = isl_set_max_val(set, obj);
+	isl_aff_free(obj);
+	if (!min || !max)
+		goto error;
+	if (isl_val_is_nan(min)) {
+		isl_val_free(min);
+		isl_val_free(max);
+		return set;
+	}
+	if (!isl_val_is_int(min) || !isl_val_is_int(max))
+		isl_die(ctx, isl_error_invalid, "set is not bounded",
+			goto error);
+
+	len = isl_val_sub(isl_val_copy(max), isl_val_copy(min));
+	len = isl_val_add_ui(len, 1);
+	lower = isl_val_add(isl_val_copy(min),
+			    chunk_offset(len, n_chunk, chunk));
+	upper = isl_val_add(min, chunk_offset(len, n_chunk, chunk + 1));
+	upper = isl_val_sub_ui(upper, 1);
+	isl_val_free(len);
+	isl_val_free(max);
+
+	set = isl_set_lower_bound_val(set, isl_dim_set, 0, lower);
+	set = isl_set_upper_bound_val(set, isl_dim_set, 0, upper);
+	return set;
+error:
+	isl_val_free(min);
+	isl_val_free(max);
+	isl_set_free(set);
+	return NULL;
+}
+
+/* Look for all integer points in chunk "chunk" out of "n_chunk" chunks
+ * of "set", which is assumed to be bounded,
+ * and call callback->add on each of them.
+ * See set_chunk for a description of the chunks.
+ *
+ * Since the chunks partition the integer points of "set",
+ * the different chunks can be scanned independently,
+ * e.g., by different threads, each using a separate isl_ctx.
+ */
+isl_stat isl_set_scan_chunk(__isl_take isl_set *set, int n_chunk, int chunk,
+	struct isl_scan_callback *callback)
+{
+	set = set_chunk(set, n_chunk, chunk);
+	return isl_set_scan(set, callback);
+}
+
 int isl_basic_set_count_upto(__isl_keep isl_basic_set *bset,
 	isl_int max, isl_int *count)
 {
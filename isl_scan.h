@@ -22,5 +22,7 @@ isl_stat isl_basic_set_scan(__isl_take isl_basic_set *bset,
 	struct isl_scan_callback *callback);
 isl_stat isl_set_scan(__isl_take isl_set *set,
 	struct isl_scan_callback *callback);
+isl_stat isl_set_scan_chunk(__isl_take isl_set *set, int n_chunk, int chunk,
+	struct isl_scan_callback *callback);
 
 #endif
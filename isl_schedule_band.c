@@ -11,6 +11,9 @@
  */
 
 #include <string.h>
+#include <isl_map_private.h>
+#include <isl_union_map_private.h>
+#include <isl_aff_private.h>
 #include <isl/val.h>
 #include <isl/space.h>
 #include <isl/map.h>
@@ -175,10 +178,47 @@ __isl_null isl_schedule_band *isl_schedule_band_free(
 	return NULL;
 }
 
+/* Are "mupa1" and "mupa2" represented in exactly the same way?
+ */
+static isl_bool multi_union_pw_aff_plain_is_identical(
+	__isl_keep isl_multi_union_pw_aff *mupa1,
+	__isl_keep isl_multi_union_pw_aff *mupa2)
+{
+	int i, n;
+	isl_space *space1, *space2;
+	isl_bool equal;
+
+	if (!mupa1 || !mupa2)
+		return isl_bool_error;
+	if (mupa1 == mupa2)
+		return isl_bool_true;
+
+	space1 = isl_multi_union_pw_aff_get_space(mupa1);
+	space2 = isl_multi_union_pw_aff_get_space(mupa2);
+	equal = isl_space_is_equal(space1, space2);
+	isl_space_free(space1);
+	isl_space_free(space2);
+
+	n = isl_multi_union_pw_aff_dim(mupa1, isl_dim_set);
+	for (i = 0; equal >= 0 && equal && i < n; ++i) {
+		isl_union_pw_aff *upa1, *upa2;
+
+		upa1 = isl_multi_union_pw_aff_get_union_pw_aff(mupa1, i);
+		upa2 = isl_multi_union_pw_aff_get_union_pw_aff(mupa2, i);
+		equal = isl_union_pw_aff_plain_is_identical(upa1, upa2);
+		isl_union_pw_aff_free(upa1);
+		isl_union_pw_aff_free(upa2);
+	}
+
+	return equal;
+}
+
 /* Are "band1" and "band2" obviously equal?
+ * If "identical" is set, then the schedule and the AST build options
+ * are required to be represented in exactly the same way.
  */
-isl_bool isl_schedule_band_plain_is_equal(__isl_keep isl_schedule_band *band1,
-	__isl_keep isl_schedule_band *band2)
+static isl_bool band_plain_is_equal(__isl_keep isl_schedule_band *band1,
+	__isl_keep isl_schedule_band *band2, int identical)
 {
 	int i;
 	isl_bool equal;
@@ -196,7 +236,12 @@ isl_bool isl_schedule_band_plain_is_equal(__isl_keep isl_schedule_band *band1,
 	if (band1->permutable != band2->permutable)
 		return isl_bool_false;
 
-	equal = isl_multi_union_pw_aff_plain_is_equal(band1->mupa, band2->mupa);
+	if (identical)
+		equal = multi_union_pw_aff_plain_is_identical(band1->mupa,
+								band2->mupa);
+	else
+		equal = isl_multi_union_pw_aff_plain_is_equal(band1->mupa,
+								band2->mupa);
 	if (equal < 0 || !equal)
 		return equal;
 
@@ -215,10 +260,30 @@ isl_bool isl_schedule_band_plain_is_equal(__isl_keep isl_schedule_band *band1,
 						band2->isolate_loop_type[i])
 				return isl_bool_false;
 
+	if (identical)
+		return isl_union_map_plain_is_identical(
+			band1->ast_build_options, band2->ast_build_options);
 	return isl_union_set_is_equal(band1->ast_build_options,
 					band2->ast_build_options);
 }
 
+/* Are "band1" and "band2" obviously equal?
+ */
+isl_bool isl_schedule_band_plain_is_equal(__isl_keep isl_schedule_band *band1,
+	__isl_keep isl_schedule_band *band2)
+{
+	return band_plain_is_equal(band1, band2, 0);
+}
+
+/* Are "band1" and "band2" represented in exactly the same way?
+ */
+isl_bool isl_schedule_band_plain_is_identical(
+	__isl_keep isl_schedule_band *band1,
+	__isl_keep isl_schedule_band *band2)
+{
+	return band_plain_is_equal(band1, band2, 1);
+}
+
 /* Return the number of scheduling dimensions in the band.
  */
 int isl_schedule_band_n_member(__isl_keep isl_schedule_band *band)
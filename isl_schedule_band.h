@@ -53,6 +53,9 @@ isl_ctx *isl_schedule_band_get_ctx(__isl_keep isl_schedule_band *band);
 
 isl_bool isl_schedule_band_plain_is_equal(__isl_keep isl_schedule_band *band1,
 	__isl_keep isl_schedule_band *band2);
+isl_bool isl_schedule_band_plain_is_identical(
+	__isl_keep isl_schedule_band *band1,
+	__isl_keep isl_schedule_band *band2);
 
 int isl_schedule_band_is_anchored(__isl_keep isl_schedule_band *band);
 
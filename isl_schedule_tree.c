@@ -13,6 +13,9 @@
  * CS 42112, 75589 Paris Cedex 12, France
  */
 
+#include <isl_map_private.h>
+#include <isl_union_map_private.h>
+#include <isl_aff_private.h>
 #include <isl/val.h>
 #include <isl/space.h>
 #include <isl/map.h>
@@ -625,9 +628,12 @@ enum isl_schedule_node_type isl_schedule_tree_get_type(
 }
 
 /* Are "tree1" and "tree2" obviously equal to each other?
+ * If "identical" is set, then the sets and relations stored
+ * in the nodes are required to be represented in exactly the same way.
+ * Otherwise, they are only required to be equal.
  */
-isl_bool isl_schedule_tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
-	__isl_keep isl_schedule_tree *tree2)
+static isl_bool tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
+	__isl_keep isl_schedule_tree *tree2, int identical)
 {
 	isl_bool equal;
 	int i, n;
@@ -641,31 +647,65 @@ isl_bool isl_schedule_tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
 
 	switch (tree1->type) {
 	case isl_schedule_node_band:
-		equal = isl_schedule_band_plain_is_equal(tree1->band,
-							tree2->band);
+		if (identical)
+			equal = isl_schedule_band_plain_is_identical(
+						tree1->band, tree2->band);
+		else
+			equal = isl_schedule_band_plain_is_equal(tree1->band,
+								tree2->band);
 		break;
 	case isl_schedule_node_context:
-		equal = isl_set_is_equal(tree1->context, tree2->context);
+		if (identical)
+			equal = isl_set_plain_is_identical(tree1->context,
+							tree2->context);
+		else
+			equal = isl_set_is_equal(tree1->context,
+							tree2->context);
 		break;
 	case isl_schedule_node_domain:
-		equal = isl_union_set_is_equal(tree1->domain, tree2->domain);
+		if (identical)
+			equal = isl_union_map_plain_is_identical(tree1->domain,
+							tree2->domain);
+		else
+			equal = isl_union_set_is_equal(tree1->domain,
+							tree2->domain);
 		break;
 	case isl_schedule_node_expansion:
-		equal = isl_union_map_is_equal(tree1->expansion,
-						tree2->expansion);
-		if (equal >= 0 && equal)
+		if (identical)
+			equal = isl_union_map_plain_is_identical(
+				    tree1->expansion, tree2->expansion);
+		else
+			equal = isl_union_map_is_equal(tree1->expansion,
+							tree2->expansion);
+		if (equal >= 0 && equal && identical)
+			equal = isl_union_pw_multi_aff_plain_is_identical(
+				    tree1->contraction, tree2->contraction);
+		else if (equal >= 0 && equal)
 			equal = isl_union_pw_multi_aff_plain_is_equal(
 				    tree1->contraction, tree2->contraction);
 		break;
 	case isl_schedule_node_extension:
-		equal = isl_union_map_is_equal(tree1->extension,
-						tree2->extension);
+		if (identical)
+			equal = isl_union_map_plain_is_identical(
+				    tree1->extension, tree2->extension);
+		else
+			equal = isl_union_map_is_equal(tree1->extension,
+							tree2->extension);
 		break;
 	case isl_schedule_node_filter:
-		equal = isl_union_set_is_equal(tree1->filter, tree2->filter);
+		if (identical)
+			equal = isl_union_map_plain_is_identical(tree1->filter,
+							tree2->filter);
+		else
+			equal = isl_union_set_is_equal(tree1->filter,
+							tree2->filter);
 		break;
 	case isl_schedule_node_guard:
-		equal = isl_set_is_equal(tree1->guard, tree2->guard);
+		if (identical)
+			equal = isl_set_plain_is_identical(tree1->guard,
+							tree2->guard);
+		else
+			equal = isl_set_is_equal(tree1->guard, tree2->guard);
 		break;
 	case isl_schedule_node_mark:
 		equal = tree1->mark == tree2->mark;
@@ -691,7 +731,7 @@ isl_bool isl_schedule_tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
 
 		child1 = isl_schedule_tree_get_child(tree1, i);
 		child2 = isl_schedule_tree_get_child(tree2, i);
-		equal = isl_schedule_tree_plain_is_equal(child1, child2);
+		equal = tree_plain_is_equal(child1, child2, identical);
 		isl_schedule_tree_free(child1);
 		isl_schedule_tree_free(child2);
 
@@ -702,6 +742,25 @@ isl_bool isl_schedule_tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
 	return isl_bool_true;
 }
 
+/* Are "tree1" and "tree2" obviously equal to each other?
+ */
+isl_bool isl_schedule_tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
+	__isl_keep isl_schedule_tree *tree2)
+{
+	return tree_plain_is_equal(tree1, tree2, 0);
+}
+
+/* Are "tree1" and "tree2" represented in exactly the same way?
+ * That is, are they obviously equal to each other and are
+ * the sets and relations stored in their nodes represented
+ * in exactly the same way?
+ */
+isl_bool isl_schedule_tree_plain_is_identical(
+	__isl_keep isl_schedule_tree *tree1, __isl_keep isl_schedule_tree *tree2)
+{
+	return tree_plain_is_equal(tree1, tree2, 1);
+}
+
 /* Does "tree" have any children, other than an implicit leaf.
  */
 int isl_schedule_tree_has_children(__isl_keep isl_schedule_tree *tree)
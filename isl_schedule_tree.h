@@ -81,6 +81,8 @@ int isl_schedule_tree_is_leaf(__isl_keep isl_schedule_tree *tree);
 
 isl_bool isl_schedule_tree_plain_is_equal(__isl_keep isl_schedule_tree *tree1,
 	__isl_keep isl_schedule_tree *tree2);
+isl_bool isl_schedule_tree_plain_is_identical(
+	__isl_keep isl_schedule_tree *tree1, __isl_keep isl_schedule_tree *tree2);
 
 __isl_give isl_schedule_tree *isl_schedule_tree_copy(
 	__isl_keep isl_schedule_tree *tree);
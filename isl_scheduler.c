@@ -314,6 +314,10 @@ static int is_multi_edge_type(struct isl_sched_edge *edge)
  * if compression is involved then the key for these maps
  * is the original, uncompressed dependence relation, while
  * the value is the dual of the compressed dependence relation.
+ * coef_hmap is a cache, only used in the root graph and therefore
+ *	shared by all graphs derived from it through splitting,
+ *	mapping the sets passed to isl_set_coefficients,
+ *	with their tuple identifiers removed, to their dual
  *
  * n is the number of nodes
  * node is the list of nodes
@@ -361,6 +365,7 @@ struct isl_sched_graph {
 	isl_map_to_basic_set *intra_hmap;
 	isl_map_to_basic_set *intra_hmap_param;
 	isl_map_to_basic_set *inter_hmap;
+	isl_map_to_basic_set *coef_hmap;
 
 	struct isl_sched_node *node;
 	int n;
@@ -721,6 +726,7 @@ static void graph_free(isl_ctx *ctx, struct isl_sched_graph *graph)
 	isl_map_to_basic_set_free(graph->intra_hmap);
 	isl_map_to_basic_set_free(graph->intra_hmap_param);
 	isl_map_to_basic_set_free(graph->inter_hmap);
+	isl_map_to_basic_set_free(graph->coef_hmap);
 
 	if (graph->node)
 		for (i = 0; i < graph->n; ++i)
@@ -1409,6 +1415,9 @@ static isl_stat graph_init(struct isl_sched_graph *graph,
 	if (compute_max_row(graph, sc) < 0)
 		return isl_stat_error;
 	graph->root = graph;
+	graph->coef_hmap = isl_map_to_basic_set_alloc(ctx, 2 * graph->n_edge);
+	if (!graph->coef_hmap)
+		return isl_stat_error;
 	graph->n = 0;
 	domain = isl_schedule_constraints_get_domain(sc);
 	domain = isl_union_set_intersect_params(domain,
@@ -1604,6 +1613,32 @@ static __isl_give isl_set *drop_coalescing_constraints(
 	return delta;
 }
 
+/* Construct the set of coefficients of valid constraints for
+ * the elements of "set", using the cache in the root of "graph".
+ * The caller is expected to have removed the tuple identifiers
+ * from "set" such that different dependence relations that
+ * only differ in the names of the statements involved, possibly
+ * in different subgraphs, end up sharing the same entry.
+ */
+static __isl_give isl_basic_set *graph_coefficients(
+	struct isl_sched_graph *graph, __isl_take isl_set *set)
+{
+	isl_basic_set *coef;
+	isl_maybe_isl_basic_set m;
+	isl_map_to_basic_set **hmap = &graph->root->coef_hmap;
+
+	m = isl_map_to_basic_set_try_get(*hmap, set);
+	if (m.valid < 0 || m.valid) {
+		isl_set_free(set);
+		return m.value;
+	}
+
+	coef = isl_set_coefficients(isl_set_copy(set));
+	*hmap = isl_map_to_basic_set_set(*hmap, set, isl_basic_set_copy(coef));
+
+	return coef;
+}
+
 /* Given a dependence relation R from "node" to itself,
  * construct the set of coefficients of valid constraints for elements
  * in that dependence relation.
@@ -1634,6 +1669,9 @@ static __isl_give isl_set *drop_coalescing_constraints(
  *
  * If "node" has been compressed, then the dependence relation
  * is also compressed before the set of coefficients is computed.
+ * The tuple identifier is removed from delta R since it does not
+ * affect the result, allowing the dual to be shared with
+ * other nodes through graph_coefficients.
  */
 static __isl_give isl_basic_set *intra_coefficients(
 	struct isl_sched_graph *graph, struct isl_sched_node *node,
@@ -1671,7 +1709,8 @@ static __isl_give isl_basic_set *intra_coefficients(
 	if (treat)
 		delta = drop_coalescing_constraints(delta, node);
 	delta = isl_set_remove_divs(delta);
-	coef = isl_set_coefficients(delta);
+	delta = isl_set_reset_tuple_id(delta);
+	coef = graph_coefficients(graph, delta);
 	*hmap = isl_map_to_basic_set_set(*hmap, key, isl_basic_set_copy(coef));
 
 	return coef;
@@ -1687,6 +1726,8 @@ static __isl_give isl_basic_set *intra_coefficients(
  * If the source or destination nodes of "edge" have been compressed,
  * then the dependence relation is also compressed before
  * the set of coefficients is computed.
+ * As in intra_coefficients, the tuple identifiers are removed
+ * before the set of coefficients is computed.
  */
 static __isl_give isl_basic_set *inter_coefficients(
 	struct isl_sched_graph *graph, struct isl_sched_edge *edge,
@@ -1710,8 +1751,11 @@ static __isl_give isl_basic_set *inter_coefficients(
 	if (edge->dst->compressed)
 		map = isl_map_preimage_range_multi_aff(map,
 				    isl_multi_aff_copy(edge->dst->decompress));
-	set = isl_map_wrap(isl_map_remove_divs(map));
-	coef = isl_set_coefficients(set);
+	map = isl_map_remove_divs(map);
+	map = isl_map_reset_tuple_id(map, isl_dim_in);
+	map = isl_map_reset_tuple_id(map, isl_dim_out);
+	set = isl_map_wrap(map);
+	coef = graph_coefficients(graph, set);
 	graph->inter_hmap = isl_map_to_basic_set_set(graph->inter_hmap, key,
 					isl_basic_set_copy(coef));
 
@@ -50,14 +50,16 @@ void isl_seq_submul(isl_int *dst, isl_int f, isl_int *src, unsigned len)
 {
 	int i;
 	for (i = 0; i < len; ++i)
-		isl_int_submul(dst[i], f, src[i]);
+		if (!isl_int_is_zero(src[i]))
+			isl_int_submul(dst[i], f, src[i]);
 }
 
 void isl_seq_addmul(isl_int *dst, isl_int f, isl_int *src, unsigned len)
 {
 	int i;
 	for (i = 0; i < len; ++i)
-		isl_int_addmul(dst[i], f, src[i]);
+		if (!isl_int_is_zero(src[i]))
+			isl_int_addmul(dst[i], f, src[i]);
 }
 
 void isl_seq_swp_or_cpy(isl_int *dst, isl_int *src, unsigned len)
@@ -102,6 +104,12 @@ void isl_seq_fdiv_r(isl_int *dst, isl_int *src, isl_int m, unsigned len)
 		isl_int_fdiv_r(dst[i], src[i], m);
 }
 
+/* Compute dst = m1 * src1 + m2 * src2.
+ *
+ * Constraint rows are typically sparse, so if the result is computed
+ * in place (and "src2" is not the same sequence), then the operations
+ * on zero elements of "src1" and "src2" are skipped.
+ */
 void isl_seq_combine(isl_int *dst, isl_int m1, isl_int *src1,
 			isl_int m2, isl_int *src2, unsigned len)
 {
@@ -111,8 +119,16 @@ void isl_seq_combine(isl_int *dst, isl_int m1, isl_int *src1,
 	if (dst == src1 && isl_int_is_one(m1)) {
 		if (isl_int_is_zero(m2))
 			return;
-		for (i = 0; i < len; ++i)
-			isl_int_addmul(src1[i], m2, src2[i]);
+		isl_seq_addmul(src1, m2, src2, len);
+		return;
+	}
+	if (dst == src1 && src1 != src2) {
+		for (i = 0; i < len; ++i) {
+			if (!isl_int_is_zero(src1[i]))
+				isl_int_mul(src1[i], m1, src1[i]);
+			if (!isl_int_is_zero(src2[i]))
+				isl_int_addmul(src1[i], m2, src2[i]);
+		}
 		return;
 	}
 
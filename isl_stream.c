@@ -8,6 +8,7 @@
  */
 
 #include <ctype.h>
+#include <limits.h>
 #include <string.h>
 #include <isl/ctx.h>
 #include <isl_stream_private.h>
@@ -76,10 +77,21 @@ struct isl_token *isl_token_new(isl_ctx *ctx,
 	tok->col = col;
 	tok->on_new_line = on_new_line;
 	tok->is_keyword = 0;
+	tok->has_static_str = 0;
 	tok->u.s = NULL;
 	return tok;
 }
 
+/* Set the string representation of "tok" to the string literal "str".
+ * The string is not copied and is therefore not freed
+ * by isl_token_free.
+ */
+static void token_set_static_str(struct isl_token *tok, const char *str)
+{
+	tok->u.s = (char *) str;
+	tok->has_static_str = 1;
+}
+
 /* Return the type of "tok".
  */
 int isl_token_get_type(struct isl_token *tok)
@@ -124,7 +136,7 @@ void isl_token_free(struct isl_token *tok)
 		isl_map_free(tok->u.map);
 	else if (tok->type == ISL_TOKEN_AFF)
 		isl_pw_aff_free(tok->u.pwaff);
-	else
+	else if (!tok->has_static_str)
 		free(tok->u.s);
 	free(tok);
 }
@@ -296,48 +308,52 @@ void isl_stream_push_token(__isl_keep isl_stream *s, struct isl_token *tok)
 	s->tokens[s->n_token++] = tok;
 }
 
+/* The keywords that are recognized by every isl_stream.
+ */
+static struct {
+	const char		*name;
+	enum isl_token_type	type;
+} builtin_keywords[] = {
+	{ "exists",	ISL_TOKEN_EXISTS },
+	{ "and",	ISL_TOKEN_AND },
+	{ "or",		ISL_TOKEN_OR },
+	{ "implies",	ISL_TOKEN_IMPLIES },
+	{ "not",	ISL_TOKEN_NOT },
+	{ "infty",	ISL_TOKEN_INFTY },
+	{ "infinity",	ISL_TOKEN_INFTY },
+	{ "NaN",	ISL_TOKEN_NAN },
+	{ "min",	ISL_TOKEN_MIN },
+	{ "max",	ISL_TOKEN_MAX },
+	{ "rat",	ISL_TOKEN_RAT },
+	{ "true",	ISL_TOKEN_TRUE },
+	{ "false",	ISL_TOKEN_FALSE },
+	{ "ceild",	ISL_TOKEN_CEILD },
+	{ "floord",	ISL_TOKEN_FLOORD },
+	{ "mod",	ISL_TOKEN_MOD },
+	{ "ceil",	ISL_TOKEN_CEIL },
+	{ "floor",	ISL_TOKEN_FLOOR },
+};
+
+/* Return the type of the identifier in s->buffer.
+ * The (case insensitive) comparison against a builtin keyword
+ * is only performed if the first characters match.
+ */
 static enum isl_token_type check_keywords(__isl_keep isl_stream *s)
 {
 	struct isl_hash_table_entry *entry;
 	struct isl_keyword *keyword;
 	uint32_t name_hash;
+	int i, n;
+	int c;
 
-	if (!strcasecmp(s->buffer, "exists"))
-		return ISL_TOKEN_EXISTS;
-	if (!strcasecmp(s->buffer, "and"))
-		return ISL_TOKEN_AND;
-	if (!strcasecmp(s->buffer, "or"))
-		return ISL_TOKEN_OR;
-	if (!strcasecmp(s->buffer, "implies"))
-		return ISL_TOKEN_IMPLIES;
-	if (!strcasecmp(s->buffer, "not"))
-		return ISL_TOKEN_NOT;
-	if (!strcasecmp(s->buffer, "infty"))
-		return ISL_TOKEN_INFTY;
-	if (!strcasecmp(s->buffer, "infinity"))
-		return ISL_TOKEN_INFTY;
-	if (!strcasecmp(s->buffer, "NaN"))
-		return ISL_TOKEN_NAN;
-	if (!strcasecmp(s->buffer, "min"))
-		return ISL_TOKEN_MIN;
-	if (!strcasecmp(s->buffer, "max"))
-		return ISL_TOKEN_MAX;
-	if (!strcasecmp(s->buffer, "rat"))
-		return ISL_TOKEN_RAT;
-	if (!strcasecmp(s->buffer, "true"))
-		return ISL_TOKEN_TRUE;
-	if (!strcasecmp(s->buffer, "false"))
-		return ISL_TOKEN_FALSE;
-	if (!strcasecmp(s->buffer, "ceild"))
-		return ISL_TOKEN_CEILD;
-	if (!strcasecmp(s->buffer, "floord"))
-		return ISL_TOKEN_FLOORD;
-	if (!strcasecmp(s->buffer, "mod"))
-		return ISL_TOKEN_MOD;
-	if (!strcasecmp(s->buffer, "ceil"))
-		return ISL_TOKEN_CEIL;
-	if (!strcasecmp(s->buffer, "floor"))
-		return ISL_TOKEN_FLOOR;
+	c = tolower(s->buffer[0]);
+	n = sizeof(builtin_keywords) / sizeof(*builtin_keywords);
+	for (i = 0; i < n; ++i) {
+		if (tolower(builtin_keywords[i].name[0]) != c)
+			continue;
+		if (!strcasecmp(s->buffer, builtin_keywords[i].name))
+			return builtin_keywords[i].type;
+	}
 
 	if (!s->keywords)
 		return ISL_TOKEN_IDENT;
@@ -429,7 +445,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			tok = isl_token_new(s->ctx, line, col, old_line != line);
 			if (!tok)
 				return NULL;
-			tok->u.s = strdup("->");
+			token_set_static_str(tok, "->");
 			tok->type = ISL_TOKEN_TO;
 			return tok;
 		}
@@ -445,6 +461,8 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 	}
 	if (c == '-' || isdigit(c)) {
 		int minus = c == '-';
+		int overflow;
+		unsigned long v;
 		tok = isl_token_new(s->ctx, line, col, old_line != line);
 		if (!tok)
 			return NULL;
@@ -452,13 +470,27 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		isl_int_init(tok->u.v);
 		if (isl_stream_push_char(s, c))
 			goto error;
-		while ((c = isl_stream_getc(s)) != -1 && isdigit(c))
+		overflow = 0;
+		v = minus ? 0 : c - '0';
+		while ((c = isl_stream_getc(s)) != -1 && isdigit(c)) {
 			if (isl_stream_push_char(s, c))
 				goto error;
+			if (v > (ULONG_MAX - (c - '0')) / 10)
+				overflow = 1;
+			else
+				v = 10 * v + (c - '0');
+		}
 		if (c != -1)
 			isl_stream_ungetc(s, c);
-		isl_stream_push_char(s, '\0');
-		isl_int_read(tok->u.v, s->buffer);
+		if (!overflow) {
+			isl_int_set_ui(tok->u.v, v);
+			if (minus)
+				isl_int_neg(tok->u.v, tok->u.v);
+		} else {
+			if (isl_stream_push_char(s, '\0'))
+				goto error;
+			isl_int_read(tok->u.v, s->buffer);
+		}
 		if (minus && isl_int_is_zero(tok->u.v)) {
 			tok->col++;
 			tok->on_new_line = 0;
@@ -515,7 +547,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup("==");
+			token_set_static_str(tok, "==");
 			tok->type = ISL_TOKEN_EQ_EQ;
 			return tok;
 		}
@@ -530,7 +562,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup(":=");
+			token_set_static_str(tok, ":=");
 			tok->type = ISL_TOKEN_DEF;
 			return tok;
 		}
@@ -545,19 +577,19 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup(">=");
+			token_set_static_str(tok, ">=");
 			tok->type = ISL_TOKEN_GE;
 			return tok;
 		} else if (c == '>') {
 			if ((c = isl_stream_getc(s)) == '=') {
-				tok->u.s = strdup(">>=");
+				token_set_static_str(tok, ">>=");
 				tok->type = ISL_TOKEN_LEX_GE;
 				return tok;
 			}
-			tok->u.s = strdup(">>");
+			token_set_static_str(tok, ">>");
 			tok->type = ISL_TOKEN_LEX_GT;
 		} else {
-			tok->u.s = strdup(">");
+			token_set_static_str(tok, ">");
 			tok->type = ISL_TOKEN_GT;
 		}
 		if (c != -1)
@@ -570,19 +602,19 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup("<=");
+			token_set_static_str(tok, "<=");
 			tok->type = ISL_TOKEN_LE;
 			return tok;
 		} else if (c == '<') {
 			if ((c = isl_stream_getc(s)) == '=') {
-				tok->u.s = strdup("<<=");
+				token_set_static_str(tok, "<<=");
 				tok->type = ISL_TOKEN_LEX_LE;
 				return tok;
 			}
-			tok->u.s = strdup("<<");
+			token_set_static_str(tok, "<<");
 			tok->type = ISL_TOKEN_LEX_LT;
 		} else {
-			tok->u.s = strdup("<");
+			token_set_static_str(tok, "<");
 			tok->type = ISL_TOKEN_LT;
 		}
 		if (c != -1)
@@ -595,10 +627,10 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			return NULL;
 		tok->type = ISL_TOKEN_AND;
 		if ((c = isl_stream_getc(s)) != '&' && c != -1) {
-			tok->u.s = strdup("&");
+			token_set_static_str(tok, "&");
 			isl_stream_ungetc(s, c);
 		} else
-			tok->u.s = strdup("&&");
+			token_set_static_str(tok, "&&");
 		return tok;
 	}
 	if (c == '|') {
@@ -607,10 +639,10 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			return NULL;
 		tok->type = ISL_TOKEN_OR;
 		if ((c = isl_stream_getc(s)) != '|' && c != -1) {
-			tok->u.s = strdup("|");
+			token_set_static_str(tok, "|");
 			isl_stream_ungetc(s, c);
 		} else
-			tok->u.s = strdup("||");
+			token_set_static_str(tok, "||");
 		return tok;
 	}
 	if (c == '/') {
@@ -621,7 +653,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			tok->type = (enum isl_token_type) '/';
 			isl_stream_ungetc(s, c);
 		} else {
-			tok->u.s = strdup("/\\");
+			token_set_static_str(tok, "/\\");
 			tok->type = ISL_TOKEN_AND;
 		}
 		return tok;
@@ -634,7 +666,7 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 			tok->type = (enum isl_token_type) '\\';
 			isl_stream_ungetc(s, c);
 		} else {
-			tok->u.s = strdup("\\/");
+			token_set_static_str(tok, "\\/");
 			tok->type = ISL_TOKEN_OR;
 		}
 		return tok;
@@ -644,12 +676,12 @@ static struct isl_token *next_token(__isl_keep isl_stream *s, int same_line)
 		if (!tok)
 			return NULL;
 		if ((c = isl_stream_getc(s)) == '=') {
-			tok->u.s = strdup("!=");
+			token_set_static_str(tok, "!=");
 			tok->type = ISL_TOKEN_NE;
 			return tok;
 		} else {
 			tok->type = ISL_TOKEN_NOT;
-			tok->u.s = strdup("!");
+			token_set_static_str(tok, "!");
 		}
 		if (c != -1)
 			isl_stream_ungetc(s, c);
@@ -7,6 +7,7 @@ struct isl_token {
 
 	unsigned int on_new_line : 1;
 	unsigned is_keyword : 1;
+	unsigned has_static_str : 1;
 	int line;
 	int col;
 
@@ -1108,11 +1108,15 @@ static void update_row_sign(struct isl_tab *tab, int row, int col, int row_sgn)
  * s(n_rc)d_r/|n_rc|		-s(n_rc)n_ri/|n_rc|
  * s(n_rc)d_r n_jc/(|n_rc| d_j)	(n_ji |n_rc| - s(n_rc)n_jc n_ri)/(|n_rc| d_j)
  *
+ * Since the rows of the tableau are typically sparse and
+ * the denominator of the pivot row is often one,
+ * multiplications by one and additions of zero are skipped.
  */
 int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 {
 	int i, j;
 	int sgn;
+	int scale;
 	int t;
 	isl_ctx *ctx;
 	struct isl_mat *mat = tab->mat;
@@ -1136,17 +1140,23 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 		}
 	if (!isl_int_is_one(mat->row[row][0]))
 		isl_seq_normalize(mat->ctx, mat->row[row], off + tab->n_col);
+	scale = !isl_int_is_one(mat->row[row][0]);
 	for (i = 0; i < tab->n_row; ++i) {
 		if (i == row)
 			continue;
 		if (isl_int_is_zero(mat->row[i][off + col]))
 			continue;
-		isl_int_mul(mat->row[i][0], mat->row[i][0], mat->row[row][0]);
+		if (scale)
+			isl_int_mul(mat->row[i][0],
+				    mat->row[i][0], mat->row[row][0]);
 		for (j = 0; j < off - 1 + tab->n_col; ++j) {
 			if (j == off - 1 + col)
 				continue;
-			isl_int_mul(mat->row[i][1 + j],
+			if (scale && !isl_int_is_zero(mat->row[i][1 + j]))
+				isl_int_mul(mat->row[i][1 + j],
 				    mat->row[i][1 + j], mat->row[row][0]);
+			if (isl_int_is_zero(mat->row[row][1 + j]))
+				continue;
 			isl_int_addmul(mat->row[i][1 + j],
 				    mat->row[i][off + col], mat->row[row][1 + j]);
 		}
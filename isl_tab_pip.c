@@ -4338,8 +4338,11 @@ static __isl_give isl_basic_map *align_context_divs(
 				goto error;
 			isl_int_set_si(bmap->div[pos][0], 0);
 		}
-		if (pos != other + i)
-			isl_basic_map_swap_div(bmap, pos, other + i);
+		if (pos == other + i)
+			continue;
+		if (isl_basic_map_own_constraints(bmap) < 0)
+			goto error;
+		isl_basic_map_swap_div(bmap, pos, other + i);
 	}
 	return bmap;
 error:
@@ -18,9 +18,11 @@
 #include <assert.h>
 #include <stdio.h>
 #include <limits.h>
+#include <stdint.h>
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl_aff_private.h>
+#include <isl_polynomial_private.h>
 #include <isl_space_private.h>
 #include <isl/set.h>
 #include <isl/flow.h>
@@ -33,10 +35,12 @@
 #include <isl/schedule_node.h>
 #include <isl_options_private.h>
 #include <isl_vertices_private.h>
+#include <isl_tab.h>
 #include <isl/ast_build.h>
 #include <isl/val.h>
 #include <isl/ilp.h>
 #include <isl_ast_build_expr.h>
+#include <isl_ast_build_private.h>
 #include <isl/options.h>
 
 #include "isl_srcdir.c"
@@ -60,6 +64,29 @@ static char *get_filename(isl_ctx *ctx, const char *name, const char *suffix) {
 	return filename;
 }
 
+/* State of the pseudo-random number generator used by the tests
+ * that generate their own inputs.  A fixed generator is used
+ * to ensure that these tests are deterministic.
+ */
+static unsigned test_random_state;
+
+/* Reset the state of the pseudo-random number generator to "seed".
+ * Each test that uses the generator resets it first such that
+ * the generated inputs do not depend on the order of the tests.
+ */
+static void test_random_seed(unsigned seed)
+{
+	test_random_state = seed;
+}
+
+/* Return a pseudo-random integer in the interval [-n, n].
+ */
+static int test_random(int n)
+{
+	test_random_state = test_random_state * 1103515245u + 12345u;
+	return (int) ((test_random_state >> 16) % (2 * n + 1)) - n;
+}
+
 void test_parse_map(isl_ctx *ctx, const char *str)
 {
 	isl_map *map;
@@ -192,6 +219,20 @@ struct {
 	  "{ [x] -> [] : 0 <= x <= 15 }" },
 	{ "{ [x] -> [x] : }",
 	  "{ [x] -> [x] }" },
+	{ "{ [i,j] : 0 <= i < 10 and j >= i and not (i = 3) }",
+	  "{ [i,j] : 0 <= i <= 9 and j >= i and (i <= 2 or i >= 4) }" },
+	{ "[n] -> { [i,j] : i, j < n and i >= floor(j/2) and j >= 0 }",
+	  "[n] -> { [i,j] : j >= 0 and i < n and j < n and 2i >= j - 1 }" },
+	{ "[n] -> { [i] : i/2 < n and 3 * (i + 1) > 2 * i + 1 - 1 }",
+	  "[n] -> { [i] : i <= 2n - 2 and i >= -2 }" },
+	{ "{ [x] : x = 18446744073709551615 }",
+	  "{ [x] : x = 18446744073709551614 + 1 }" },
+	{ "{ [x] : x = -18446744073709551616 }",
+	  "{ [x] : -x = 9223372036854775808 * 2 }" },
+	{ "{ [x] : x >= -0 and x <= 99999999999999999999 }",
+	  "{ [x] : 0 <= x <= 9999999999 * 10000000000 + 9999999999 }" },
+	{ "{ [i,j] -> [k] : k = i + j and i < j and (i > 0 or j > 5) }",
+	  "{ [i,j] -> [i + j] : 0 < i < j; [i,j] -> [i + j] : 5 < j and i < j }" },
 };
 
 int test_parse(struct isl_ctx *ctx)
@@ -1205,7 +1246,7 @@ void test_convex_hull_case(struct isl_ctx *ctx, const char *name)
 {
 	char *filename;
 	FILE *input;
-	struct isl_basic_set *bset1, *bset2;
+	struct isl_basic_set *bset1, *bset2, *hull;
 	struct isl_set *set;
 
 	filename = get_filename(ctx, name, "polylib");
@@ -1216,15 +1257,19 @@ void test_convex_hull_case(struct isl_ctx *ctx, const char *name)
 	bset1 = isl_basic_set_read_from_file(ctx, input);
 	bset2 = isl_basic_set_read_from_file(ctx, input);
 
-	set = isl_basic_set_union(bset1, bset2);
+	set = isl_basic_set_union(isl_basic_set_copy(bset1),
+				    isl_basic_set_copy(bset2));
+	hull = isl_basic_set_union_convex_hull(bset1, bset2);
 	bset1 = isl_set_convex_hull(set);
 
 	bset2 = isl_basic_set_read_from_file(ctx, input);
 
 	assert(isl_basic_set_is_equal(bset1, bset2) == 1);
+	assert(isl_basic_set_is_equal(hull, bset2) == 1);
 
 	isl_basic_set_free(bset1);
 	isl_basic_set_free(bset2);
+	isl_basic_set_free(hull);
 	free(filename);
 
 	fclose(input);
@@ -1249,8 +1294,150 @@ struct {
 	{ "{ [x, y, z] : 0 <= x, y, z <= 10; [x, y, 0] : x >= 0 and y > 0; "
 	    "[x, y, 0] : x >= 0 and y < 0 }",
 	    "{ [x, y, z] : x >= 0 and 0 <= z <= 10 }" },
+	{ "{ [x, y] : 0 <= x, y <= 2; [x, y] : 1 <= x <= 4 and 0 <= y <= 1; "
+	    "[x, y] : 1 <= x, y <= 2 }",
+	    "{ [x, y] : 0 <= x <= 4 and 0 <= y <= 2 and x + 2y <= 6 }" },
 };
 
+/* Compute the convex hull of "set" by adding its basic sets
+ * one by one using isl_basic_set_union_convex_hull.
+ */
+static __isl_give isl_basic_set *incremental_convex_hull(
+	__isl_take isl_set *set)
+{
+	int i, n;
+	isl_basic_set_list *list;
+	isl_basic_set *hull;
+
+	list = isl_set_get_basic_set_list(set);
+	n = isl_basic_set_list_n_basic_set(list);
+	if (n == 0)
+		hull = isl_basic_set_empty(isl_set_get_space(set));
+	else
+		hull = isl_basic_set_list_get_basic_set(list, 0);
+	for (i = 1; i < n; ++i) {
+		isl_basic_set *bset;
+
+		bset = isl_basic_set_list_get_basic_set(list, i);
+		hull = isl_basic_set_union_convex_hull(hull, bset);
+	}
+	isl_basic_set_list_free(list);
+	isl_set_free(set);
+
+	return hull;
+}
+
+/* Add the constraint "cst + sum_i coef[i] x_i >= 0" to "bset".
+ */
+static __isl_give isl_basic_set *add_random_ineq(
+	__isl_take isl_basic_set *bset, __isl_keep isl_local_space *ls,
+	int cst, int *coef, int d)
+{
+	int i;
+	isl_constraint *c;
+
+	c = isl_constraint_alloc_inequality(isl_local_space_copy(ls));
+	c = isl_constraint_set_constant_si(c, cst);
+	for (i = 0; i < d; ++i)
+		c = isl_constraint_set_coefficient_si(c, isl_dim_set, i,
+							coef[i]);
+	return isl_basic_set_add_constraint(bset, c);
+}
+
+/* Construct a pseudo-random non-empty bounded basic set
+ * in a "d"-dimensional space, with d at most 3.
+ * The basic set is a box around a random center, cut by
+ * two random constraints that are satisfied by this center.
+ * The cuts may make some of the box constraints redundant
+ * for the integer points, but not for the rational points.
+ */
+static __isl_give isl_basic_set *random_polytope(isl_ctx *ctx, int d)
+{
+	int i, j, k;
+	int center[3], coef[3];
+	isl_space *space;
+	isl_local_space *ls;
+	isl_basic_set *bset;
+
+	space = isl_space_set_alloc(ctx, 0, d);
+	bset = isl_basic_set_universe(isl_space_copy(space));
+	ls = isl_local_space_from_space(space);
+	for (i = 0; i < d; ++i)
+		center[i] = test_random(10);
+	for (i = 0; i < d; ++i) {
+		for (j = 0; j < d; ++j)
+			coef[j] = i == j;
+		k = 1 + abs(test_random(3));
+		bset = add_random_ineq(bset, ls, k - center[i], coef, d);
+		for (j = 0; j < d; ++j)
+			coef[j] = -(i == j);
+		k = 1 + abs(test_random(3));
+		bset = add_random_ineq(bset, ls, k + center[i], coef, d);
+	}
+	for (k = 0; k < 2; ++k) {
+		int cst = 5 + abs(test_random(5));
+
+		for (j = 0; j < d; ++j) {
+			coef[j] = test_random(4);
+			cst -= coef[j] * center[j];
+		}
+		bset = add_random_ineq(bset, ls, cst, coef, d);
+	}
+	isl_local_space_free(ls);
+
+	return bset;
+}
+
+/* Check that computing the convex hull of a collection of pseudo-random
+ * bounded basic sets one basic set at a time
+ * using isl_basic_set_union_convex_hull produces the same result
+ * as computing the convex hull of the rational relaxation
+ * of the entire collection at once.
+ * In particular, check that none of the facets of the convex hull
+ * gets lost along the way.
+ * The results are compared as rational sets, such that
+ * a looser result is detected even if it has the same integer points.
+ * This test is only run when the wrapping based convex hull computation
+ * is selected since isl_basic_set_union_convex_hull only reuses
+ * the facets of the first argument in this case.
+ */
+static int test_incremental_convex_hull_random(isl_ctx *ctx)
+{
+	int i, j;
+
+	test_random_seed(1);
+	for (i = 0; i < 16; ++i) {
+		int d = 2 + i % 2;
+		int equal;
+		isl_basic_set *hull, *bset;
+		isl_set *set;
+
+		hull = random_polytope(ctx, d);
+		set = isl_set_from_basic_set(isl_basic_set_copy(hull));
+		for (j = 0; j < 5; ++j) {
+			bset = random_polytope(ctx, d);
+			set = isl_set_union(set,
+				isl_set_from_basic_set(isl_basic_set_copy(bset)));
+			hull = isl_basic_set_union_convex_hull(hull, bset);
+		}
+		set = isl_set_set_rational(set);
+		bset = isl_basic_set_set_rational(isl_set_convex_hull(set));
+		hull = isl_basic_set_set_rational(hull);
+		equal = isl_basic_set_is_equal(hull, bset);
+		isl_basic_set_free(hull);
+		isl_basic_set_free(bset);
+
+		if (equal < 0)
+			return -1;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"incremental convex hull differs from "
+				"convex hull", return -1);
+	}
+
+	return 0;
+}
+
 static int test_convex_hull_algo(isl_ctx *ctx, int convex)
 {
 	int i;
@@ -1275,15 +1462,20 @@ static int test_convex_hull_algo(isl_ctx *ctx, int convex)
 	test_convex_hull_case(ctx, "convex15");
 
 	for (i = 0; i < ARRAY_SIZE(convex_hull_tests); ++i) {
-		isl_set *set1, *set2;
+		isl_set *set1, *set2, *set3;
 		int equal;
 
 		set1 = isl_set_read_from_str(ctx, convex_hull_tests[i].set);
 		set2 = isl_set_read_from_str(ctx, convex_hull_tests[i].hull);
+		set3 = isl_set_from_basic_set(incremental_convex_hull(
+							isl_set_copy(set1)));
 		set1 = isl_set_from_basic_set(isl_set_convex_hull(set1));
 		equal = isl_set_is_equal(set1, set2);
+		if (equal >= 0 && equal)
+			equal = isl_set_is_equal(set3, set2);
 		isl_set_free(set1);
 		isl_set_free(set2);
+		isl_set_free(set3);
 
 		if (equal < 0)
 			return -1;
@@ -1292,6 +1484,10 @@ static int test_convex_hull_algo(isl_ctx *ctx, int convex)
 				"unexpected convex hull", return -1);
 	}
 
+	if (convex == ISL_CONVEX_HULL_WRAP &&
+	    test_incremental_convex_hull_random(ctx) < 0)
+		return -1;
+
 	ctx->opt->convex = orig_convex;
 
 	return 0;
@@ -2305,6 +2501,145 @@ static int test_closure(isl_ctx *ctx)
 	return 0;
 }
 
+/* Compute the transitive closure (if "power" is not set) or
+ * the power (if "power" is set) of the relation described by "str".
+ */
+static __isl_give isl_map *compute_closure(isl_ctx *ctx, const char *str,
+	int power, int *exact)
+{
+	isl_map *map;
+
+	map = isl_map_read_from_str(ctx, str);
+	if (power)
+		return isl_map_power(map, exact);
+	else
+		return isl_map_transitive_closure(map, exact);
+}
+
+/* Compute the transitive closure (if "power" is not set) or
+ * the power (if "power" is set) of the relation described by "str"
+ * with the closure_cache option set and check that the result
+ * is the same as "expected" and that its exactness is "expected_exact".
+ * If "hit" is set, then check that the result was taken from the cache.
+ * Otherwise, check that it was not.
+ */
+static isl_stat check_closure_cache(isl_ctx *ctx, const char *str,
+	int power, __isl_keep isl_map *expected, int expected_exact, int hit)
+{
+	isl_map *map;
+	int exact;
+	int n_hit;
+	isl_bool equal;
+
+	if (isl_options_set_closure_cache(ctx, 1) < 0)
+		return isl_stat_error;
+	n_hit = isl_ctx_get_closure_cache_n_hit(ctx);
+	map = compute_closure(ctx, str, power, &exact);
+	equal = isl_map_is_equal(map, expected);
+	isl_map_free(map);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal || exact != expected_exact)
+		isl_die(ctx, isl_error_unknown,
+			"cached result differs from computed result",
+			return isl_stat_error);
+	if ((isl_ctx_get_closure_cache_n_hit(ctx) > n_hit) != hit)
+		isl_die(ctx, isl_error_unknown,
+			hit ? "expecting cache hit" : "unexpected cache hit",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Inputs for test_closure_cache.
+ */
+static const char *closure_cache_tests[] = {
+	"[n] -> { [i,j] -> [i2,j2] : i2 = i + 1 and j2 = j + 1 and "
+		"1 <= i and i < n and 1 <= j and j < n or "
+		"i2 = i + 1 and j2 = j - 1 and "
+		"1 <= i and i < n and 2 <= j and j <= n }",
+	"{ [x] -> [x + 1] : 0 <= x < 10; [x] -> [x + 2] : 20 <= x < 30 }",
+	"[m,n] -> { [i] -> [j] : exists (a : j = i + 2a and 1 <= a <= m and "
+		"0 <= i and j <= n) }",
+};
+
+/* Perform the checks of test_closure_cache on the input "str",
+ * for the transitive closure if "power" is not set and
+ * for the power if "power" is set.
+ *
+ * Turning off the closure_cache option should release the cache.
+ * The result is first computed without the cache, both for
+ * the current value of the closure option and for ISL_CLOSURE_BOX.
+ * Each result is then computed twice with the cache,
+ * where the second computation should find the result in the cache.
+ * The result for the original value of the closure option
+ * should not be taken from the cache when computing
+ * the result for ISL_CLOSURE_BOX, but it should still
+ * be available afterwards.
+ * Note that the transitive closure is computed without using
+ * the cache in case of ISL_CLOSURE_BOX, so the result can only
+ * be found in the cache when computing the power.
+ * None of the inputs is transitively closed since the cache
+ * is not used for such inputs either.
+ */
+static isl_stat check_closure_cache_input(isl_ctx *ctx, const char *str,
+	int power)
+{
+	int j, exact, exact_box;
+	unsigned closure;
+	isl_map *expected, *expected_box;
+	isl_stat r = isl_stat_ok;
+
+	if (isl_options_set_closure_cache(ctx, 0) < 0)
+		return isl_stat_error;
+	if (ctx->closure_cache)
+		isl_die(ctx, isl_error_unknown,
+			"closure cache not released", return isl_stat_error);
+	closure = ctx->opt->closure;
+	expected = compute_closure(ctx, str, power, &exact);
+	ctx->opt->closure = ISL_CLOSURE_BOX;
+	expected_box = compute_closure(ctx, str, power, &exact_box);
+	ctx->opt->closure = closure;
+
+	for (j = 0; r >= 0 && j < 2; ++j)
+		r = check_closure_cache(ctx, str, power, expected, exact, j);
+	ctx->opt->closure = ISL_CLOSURE_BOX;
+	for (j = 0; r >= 0 && j < 2; ++j)
+		r = check_closure_cache(ctx, str, power,
+					expected_box, exact_box, power && j);
+	ctx->opt->closure = closure;
+	if (r >= 0)
+		r = check_closure_cache(ctx, str, power, expected, exact, 1);
+
+	isl_map_free(expected);
+	isl_map_free(expected_box);
+
+	return r;
+}
+
+/* Check that computing transitive closures and powers with
+ * the closure_cache option set produces the same results
+ * as computing them without the cache, both when the result
+ * is first computed and when it is retrieved from the cache.
+ * The closure_cache option is restored to its original value,
+ * also when any of the checks fails.
+ */
+static int test_closure_cache(isl_ctx *ctx)
+{
+	int i, power;
+	int orig;
+	isl_stat r = isl_stat_ok;
+
+	orig = isl_options_get_closure_cache(ctx);
+	for (i = 0; r >= 0 && i < ARRAY_SIZE(closure_cache_tests); ++i)
+		for (power = 0; r >= 0 && power <= 1; ++power)
+			r = check_closure_cache_input(ctx,
+					closure_cache_tests[i], power);
+	if (isl_options_set_closure_cache(ctx, orig) < 0)
+		return -1;
+
+	return r < 0 ? -1 : 0;
+}
+
 static int test_lex(struct isl_ctx *ctx)
 {
 	isl_space *dim;
@@ -3020,6 +3355,24 @@ static int test_pwqp(struct isl_ctx *ctx)
 	if (!equal)
 		isl_die(ctx, isl_error_unknown, "unexpected result", return -1);
 
+	str = "{ [x,y,z] -> (1/2 * x + y - 2/3 * z + 1)^3 * "
+		"(1/2 * x - y + z)^2 * (x + 1/3 * y - z - 1)^2 }";
+	pwqp1 = isl_pw_qpolynomial_read_from_str(ctx, str);
+	str = "{ [x,y,z] -> (1/2 * x + y - 2/3 * z + 1) * "
+		"(1/2 * x - y + z) * (x + 1/3 * y - z - 1) }";
+	pwqp2 = isl_pw_qpolynomial_read_from_str(ctx, str);
+	pwqp2 = isl_pw_qpolynomial_mul(isl_pw_qpolynomial_copy(pwqp2), pwqp2);
+	str = "{ [x,y,z] -> (1/2 * x + y - 2/3 * z + 1) }";
+	pwqp2 = isl_pw_qpolynomial_mul(pwqp2,
+				isl_pw_qpolynomial_read_from_str(ctx, str));
+	pwqp1 = isl_pw_qpolynomial_sub(pwqp1, pwqp2);
+	equal = isl_pw_qpolynomial_is_zero(pwqp1);
+	isl_pw_qpolynomial_free(pwqp1);
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown, "unexpected result", return -1);
+
 	str = "{ [a,b,c] -> (([(2*[a/3]+1)/5]) * ([(2*[c/3]+1)/5])) : b = 1 }";
 	pwqp2 = isl_pw_qpolynomial_read_from_str(ctx, str);
 	str = "{ [a,b,c] -> (([(2*[a/3]+b)/5]) * ([(2*[c/3]+b)/5])) }";
@@ -3132,6 +3485,90 @@ static int test_bound_unbounded_domain(isl_ctx *ctx)
 	return 0;
 }
 
+/* Elements of the reductions constructed in test_bound_fold_tab.
+ */
+static const char *fold_tab_elements[] = {
+	"[n, m] -> { [(n)] }",
+	"[n, m] -> { [(m)] }",
+	"[n, m] -> { [(2m - n)] }",
+	"[n, m] -> { [(5)] }",
+	"[n, m] -> { [(n - m + 1)] }",
+	"[n, m] -> { [(floor(n/2))] }",
+	"[n, m] -> { [(10 - n)] }",
+};
+
+/* Construct a reduction of type "type" from the elements
+ * in fold_tab_elements and the product of the first two elements
+ * on the domain "dom", with tableau representation "tab" (if not NULL).
+ */
+static __isl_give isl_qpolynomial_fold *fold_tab_construct(isl_ctx *ctx,
+	enum isl_fold type, __isl_keep isl_set *dom, struct isl_tab *tab)
+{
+	int i;
+	isl_qpolynomial *qp, *prod = NULL;
+	isl_qpolynomial_fold *fold, *fold_i;
+
+	fold = isl_qpolynomial_fold_empty(type, isl_set_get_space(dom));
+	for (i = 0; i < ARRAY_SIZE(fold_tab_elements); ++i) {
+		qp = isl_qpolynomial_from_aff(isl_aff_read_from_str(ctx,
+							fold_tab_elements[i]));
+		if (i == 0)
+			prod = isl_qpolynomial_copy(qp);
+		else if (i == 1)
+			prod = isl_qpolynomial_mul(prod,
+						isl_qpolynomial_copy(qp));
+		fold_i = isl_qpolynomial_fold_alloc(type, qp);
+		fold = isl_qpolynomial_fold_fold_on_domain_tab(dom, tab,
+								fold, fold_i);
+	}
+	fold_i = isl_qpolynomial_fold_alloc(type, prod);
+	fold = isl_qpolynomial_fold_fold_on_domain_tab(dom, tab, fold, fold_i);
+
+	return fold;
+}
+
+/* Check that constructing a reduction using a shared tableau
+ * representation of the domain, as done by bernstein expansion,
+ * produces the same result as constructing it using
+ * a fresh LP problem for each comparison.
+ * The LP problems are solved by the tableau based solver in both cases
+ * since isl_set_solve_lp does not support any other LP solver.
+ */
+static int test_bound_fold_tab(isl_ctx *ctx)
+{
+	int equal = 1;
+	enum isl_fold type;
+	isl_basic_set *bset;
+	isl_set *dom;
+	struct isl_tab *tab;
+
+	bset = isl_basic_set_read_from_str(ctx,
+					"[n, m] -> { : 0 <= m <= n <= 10 }");
+	dom = isl_set_from_basic_set(isl_basic_set_copy(bset));
+	tab = isl_tab_from_basic_set(bset, 0);
+	isl_basic_set_free(bset);
+	for (type = isl_fold_min; equal == 1 && type <= isl_fold_max; ++type) {
+		isl_qpolynomial_fold *fold1, *fold2;
+
+		fold1 = fold_tab_construct(ctx, type, dom, NULL);
+		fold2 = fold_tab_construct(ctx, type, dom, tab);
+		equal = isl_qpolynomial_fold_plain_is_equal(fold1, fold2);
+		isl_qpolynomial_fold_free(fold1);
+		isl_qpolynomial_fold_free(fold2);
+	}
+	isl_tab_free(tab);
+	isl_set_free(dom);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"reductions constructed with shared tableau differ",
+			return -1);
+
+	return 0;
+}
+
 static int test_bound(isl_ctx *ctx)
 {
 	const char *str;
@@ -3141,6 +3578,8 @@ static int test_bound(isl_ctx *ctx)
 
 	if (test_bound_unbounded_domain(ctx) < 0)
 		return -1;
+	if (test_bound_fold_tab(ctx) < 0)
+		return -1;
 
 	str = "{ [[a, b, c, d] -> [e]] -> 0 }";
 	pwqp = isl_pw_qpolynomial_read_from_str(ctx, str);
@@ -3215,6 +3654,29 @@ struct {
 			"4e0 >= -61 + i0 + i1)) or "
 		"(i1 <= 66 - i0 and i0 >= 2 and i1 >= 59 + i0) }", 1 },
 	{ "[a, b] -> { : a = 0 and b = -1 }", "[b, a] -> { : b >= -10 }", 1 },
+	{ "{ [i] : 0 <= i <= 10 }", "{ [i] : i <= 4 or i >= 6 }", 0 },
+	{ "{ [i] : 0 <= i <= 10 }", "{ [i] : i <= 4 or i >= 5 }", 1 },
+	{ "{ [i] : 0 <= i <= 10 }",
+	  "{ [i] : exists (e : i = 2e) or exists (e : i = 2e + 1) }", 1 },
+	{ "{ [i, j] : 0 <= i, j <= 10 }",
+	  "{ [i, j] : exists (e : i + j = 3e) or exists (e : i + j = 3e + 1) }",
+	  0 },
+	{ "{ [i, j] : 0 <= i <= 10 and 2 <= j <= 5 }",
+	  "{ [i, j] : i + j <= 15 and i - j >= -5 }", 1 },
+	{ "{ [i, j] : 0 <= i <= 10 and 2 <= j <= 6 }",
+	  "{ [i, j] : i + j <= 15 and i - j >= -5 }", 0 },
+	{ "{ [i, j] : 0 <= 2i <= 21 and j = 3 }",
+	  "{ [i, j] : i + j <= 13 and j = 3 }", 1 },
+	{ "{ [i, j] : 0 <= i <= 10 and 3 <= j <= 4 }",
+	  "{ [i, j] : i + j <= 13 and j = 3 }", 0 },
+	{ "{ [i, j] : 0 <= i and j = 3 }", "{ [i, j] : i + j >= 3 }", 1 },
+	{ "{ [i, j] : 0 <= i and j = 3 }", "{ [i, j] : i + j <= 100 }", 0 },
+	{ "{ [i, j] : 0 <= i <= 3 and 3 <= 2j <= 3 }",
+	  "{ [i, j] : i + j <= -1 }", 1 },
+	{ "[n] -> { [i] : 0 <= i <= 10 and n = 5 }",
+	  "[n] -> { [i] : i <= 2n }", 1 },
+	{ "[n] -> { [i] : 0 <= i <= 10 and 4 <= n <= 5 }",
+	  "[n] -> { [i] : i <= 2n }", 0 },
 };
 
 static int test_subset(isl_ctx *ctx)
@@ -4614,6 +5076,7 @@ struct {
 } pw_aff_bin_op[] = {
 	['m'] = { &isl_pw_aff_min },
 	['M'] = { &isl_pw_aff_max },
+	['a'] = { &isl_pw_aff_union_add },
 };
 
 /* Inputs for binary isl_pw_aff operation tests.
@@ -4638,6 +5101,23 @@ struct {
 	  "{ [i] -> [NaN] }" },
 	{ "{ [i] -> [NaN] }", 'm', "{ [i] -> [i] }",
 	  "{ [i] -> [NaN] }" },
+	{ "{ [i] -> [0] : 0 <= i < 10; [i] -> [1] : 10 <= i < 20; "
+	    "[i] -> [2] : 20 <= i < 30; [i] -> [3] : 30 <= i < 40 }", 'a',
+	  "{ [i] -> [i] : 5 <= i < 8; [i] -> [2i] : 12 <= i < 15; "
+	    "[i] -> [3i] : 25 <= i < 28; [i] -> [4i] : 40 <= i < 50 }",
+	  "{ [i] -> [0] : 0 <= i < 5 or 8 <= i < 10; [i] -> [i] : 5 <= i < 8; "
+	    "[i] -> [1] : 10 <= i < 12 or 15 <= i < 20; "
+	    "[i] -> [1 + 2i] : 12 <= i < 15; "
+	    "[i] -> [2] : 20 <= i < 25 or 28 <= i < 30; "
+	    "[i] -> [2 + 3i] : 25 <= i < 28; [i] -> [3] : 30 <= i < 40; "
+	    "[i] -> [4i] : 40 <= i < 50 }" },
+	{ "{ [i] -> [0] : 0 <= i < 10; [i] -> [1] : 10 <= i < 20; "
+	    "[i] -> [2] : 20 <= i < 30; [i] -> [3] : 30 <= i < 40 }", 'M',
+	  "{ [i] -> [i - 5] : 0 <= i < 10; [i] -> [-1] : 10 <= i < 20; "
+	    "[i] -> [5] : 20 <= i < 30; [i] -> [3] : 30 <= i < 40 }",
+	  "{ [i] -> [0] : 0 <= i < 6; [i] -> [i - 5] : 6 <= i < 10; "
+	    "[i] -> [1] : 10 <= i < 20; [i] -> [5] : 20 <= i < 30; "
+	    "[i] -> [3] : 30 <= i < 40 }" },
 };
 
 /* Perform some basic tests of binary operations on isl_pw_aff objects.
@@ -5393,6 +5873,106 @@ static int test_eval_2(isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that the value "num / den" computed by
+ * isl_pw_qpolynomial_eval_batch_si in the point "pnt" of "pwqp"
+ * is equal to the value computed by isl_pw_qpolynomial_eval.
+ */
+static isl_stat check_eval_batch_point(__isl_keep isl_pw_qpolynomial *pwqp,
+	long *pnt, long num, long den)
+{
+	int i, n;
+	isl_ctx *ctx;
+	isl_set *set;
+	isl_val *v, *expected;
+	isl_bool ok;
+
+	ctx = isl_pw_qpolynomial_get_ctx(pwqp);
+	set = isl_set_universe(isl_pw_qpolynomial_get_domain_space(pwqp));
+	n = isl_pw_qpolynomial_dim(pwqp, isl_dim_param);
+	for (i = 0; i < n; ++i)
+		set = isl_set_fix_val(set, isl_dim_param, i,
+					isl_val_int_from_si(ctx, pnt[i]));
+	for (i = 0; i < isl_pw_qpolynomial_dim(pwqp, isl_dim_in); ++i)
+		set = isl_set_fix_val(set, isl_dim_set, i,
+					isl_val_int_from_si(ctx, pnt[n + i]));
+	v = isl_pw_qpolynomial_eval(isl_pw_qpolynomial_copy(pwqp),
+				    isl_set_sample_point(set));
+	v = isl_val_mul(v, isl_val_int_from_si(ctx, den));
+	expected = isl_val_int_from_si(ctx, num);
+	ok = isl_val_eq(v, expected);
+	isl_val_free(expected);
+	isl_val_free(v);
+
+	if (ok < 0)
+		return isl_stat_error;
+	if (!ok)
+		isl_die(ctx, isl_error_unknown, "unexpected value",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Piecewise quasi-polynomials with a two-dimensional domain
+ * (including parameters) that are evaluated on a grid of points
+ * by test_eval_3.  The pieces of the second one have bounded domains,
+ * such that most of the grid points lie outside the bounding box
+ * of most of the pieces.
+ */
+const char *eval_batch_tests[] = {
+	"[n] -> { [i] -> floor((i + n)/3) * i + 1/2 * n^2 : 0 <= i <= n; "
+		"[i] -> i - n : i > n and i mod 2 = 0 }",
+	"{ [i, j] -> i + j : 0 <= i, j <= 2; "
+		"[i, j] -> i * j : 3 <= i <= 5 and -3 <= j <= 2; "
+		"[i, j] -> floor(j/2) : 0 <= i <= 5 and 3 <= j <= 8 and "
+		"(i + j) mod 2 = 0 }",
+};
+
+/* Check isl_pw_qpolynomial_eval_batch_si on a grid of points that
+ * can be evaluated using native integer arithmetic and
+ * on a point that requires exact arithmetic.
+ */
+static int test_eval_3(isl_ctx *ctx)
+{
+	const char *str;
+	isl_pw_qpolynomial *pwqp;
+	long pnt[2 * 9 * 12];
+	long num[9 * 12];
+	long den;
+	int i, j, k, n = 0;
+	isl_stat r;
+
+	for (i = -3; i <= 5; ++i)
+		for (j = -3; j <= 8; ++j) {
+			pnt[2 * n] = i;
+			pnt[2 * n + 1] = j;
+			n++;
+		}
+	for (k = 0; k < ARRAY_SIZE(eval_batch_tests); ++k) {
+		str = eval_batch_tests[k];
+		pwqp = isl_pw_qpolynomial_read_from_str(ctx, str);
+		r = isl_pw_qpolynomial_eval_batch_si(pwqp, n, pnt, num, &den);
+		for (i = 0; r >= 0 && i < n; ++i)
+			r = check_eval_batch_point(pwqp, pnt + 2 * i,
+						    num[i], den);
+		isl_pw_qpolynomial_free(pwqp);
+		if (r < 0)
+			return -1;
+	}
+
+	str = "[n] -> { [i] -> i + n : i >= 0 }";
+	pwqp = isl_pw_qpolynomial_read_from_str(ctx, str);
+	/* The value fits in a long, but exceeds the native evaluation limit. */
+	pnt[0] = pnt[1] = LONG_MAX / 8 * 3;
+	r = isl_pw_qpolynomial_eval_batch_si(pwqp, 1, pnt, num, &den);
+	if (r >= 0)
+		r = check_eval_batch_point(pwqp, pnt, num[0], den);
+	isl_pw_qpolynomial_free(pwqp);
+	if (r < 0)
+		return -1;
+
+	return 0;
+}
+
 /* Perform basic polynomial evaluation tests.
  */
 static int test_eval(isl_ctx *ctx)
@@ -5401,6 +5981,8 @@ static int test_eval(isl_ctx *ctx)
 		return -1;
 	if (test_eval_2(ctx) < 0)
 		return -1;
+	if (test_eval_3(ctx) < 0)
+		return -1;
 	return 0;
 }
 
@@ -5481,12 +6063,68 @@ int test_output(isl_ctx *ctx)
 	return 0;
 }
 
-int test_sample(isl_ctx *ctx)
+/* Check that isl_basic_set_sample finds a point in the (non-empty)
+ * basic set described by "str".
+ */
+static int test_sample_set(isl_ctx *ctx, const char *str)
 {
-	const char *str;
 	isl_basic_set *bset1, *bset2;
 	int empty, subset;
 
+	bset1 = isl_basic_set_read_from_str(ctx, str);
+	bset2 = isl_basic_set_sample(isl_basic_set_copy(bset1));
+	empty = isl_basic_set_is_empty(bset2);
+	subset = isl_basic_set_is_subset(bset2, bset1);
+	isl_basic_set_free(bset1);
+	isl_basic_set_free(bset2);
+	if (empty < 0 || subset < 0)
+		return -1;
+	if (empty)
+		isl_die(ctx, isl_error_unknown, "point not found", return -1);
+	if (!subset)
+		isl_die(ctx, isl_error_unknown, "bad point found", return -1);
+
+	return 0;
+}
+
+/* Basic sets with constraints that involve at most two variables
+ * with unit coefficients and that do not contain any integer points.
+ */
+static const char *octagon_empty_tests[] = {
+	"{ [x, y, z] : x + y <= 1 and x + y >= 1 and x - y <= 0 and "
+	    "x - y >= 0 and -10 <= z <= 10 }",
+	"{ [x, y, z] : y - x >= 1 and z - y >= 1 and x - z >= -1 }",
+	"{ [x, y, z] : 0 <= x <= 10 and x + y = 3 and y - z = 1 and "
+	    "x + z = 0 }",
+};
+
+/* Check that the basic sets in octagon_empty_tests are found to be empty.
+ */
+static int test_octagon_empty(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(octagon_empty_tests); ++i) {
+		isl_basic_set *bset;
+		isl_bool empty;
+
+		bset = isl_basic_set_read_from_str(ctx, octagon_empty_tests[i]);
+		empty = isl_basic_set_is_empty(bset);
+		isl_basic_set_free(bset);
+		if (empty < 0)
+			return -1;
+		if (!empty)
+			isl_die(ctx, isl_error_unknown,
+				"expecting empty set", return -1);
+	}
+
+	return 0;
+}
+
+int test_sample(isl_ctx *ctx)
+{
+	const char *str;
+
 	str = "{ [a, b, c, d, e, f, g, h, i, j, k] : "
 	    "3i >= 1073741823b - c - 1073741823e + f and c >= 0 and "
 	    "3i >= -1 + 3221225466b + c + d - 3221225466e - f and "
@@ -5513,46 +6151,114 @@ int test_sample(isl_ctx *ctx)
 	    "1073741823e >= 1 + 1073741823b - d and "
 	    "3i >= 1073741823b + c - 1073741823e - f and "
 	    "3i >= 1 + 2b + e + 3g }";
-	bset1 = isl_basic_set_read_from_str(ctx, str);
-	bset2 = isl_basic_set_sample(isl_basic_set_copy(bset1));
-	empty = isl_basic_set_is_empty(bset2);
-	subset = isl_basic_set_is_subset(bset2, bset1);
-	isl_basic_set_free(bset1);
-	isl_basic_set_free(bset2);
-	if (empty < 0 || subset < 0)
+	if (test_sample_set(ctx, str) < 0)
 		return -1;
-	if (empty)
-		isl_die(ctx, isl_error_unknown, "point not found", return -1);
-	if (!subset)
-		isl_die(ctx, isl_error_unknown, "bad point found", return -1);
 
-	return 0;
-}
+	str = "{ [a, b, c, d, e, f, g, h] : "
+	    "-100 <= a, b, c, d, e, f, g, h <= 100 and "
+	    "677 <= -18a - 15b + 15c - 17d - 3e + 18f + 19g + 5h <= 678 and "
+	    "19a - 7b - 3c - 4d - 7e - 16f - 3g + 15h = 315 and "
+	    "504 <= 18a - 6b + 6c - 6d - 4e - 3f - 2g - 10h <= 506 }";
+	if (test_sample_set(ctx, str) < 0)
+		return -1;
 
-int test_fixed_power(isl_ctx *ctx)
-{
-	const char *str;
-	isl_map *map;
-	isl_val *exp;
-	int equal;
+	str = "{ [a, b, c, d] : a - b <= 9 and b - c <= -2 and c - d <= 5 and "
+	    "d - a <= 0 and a + d >= 7 and -b - c <= 4 and 3a <= 20 and "
+	    "b + d = 1 }";
+	if (test_sample_set(ctx, str) < 0)
+		return -1;
 
-	str = "{ [i] -> [i + 1] }";
-	map = isl_map_read_from_str(ctx, str);
-	exp = isl_val_int_from_si(ctx, 23);
-	map = isl_map_fixed_power_val(map, exp);
-	equal = map_check_equal(map, "{ [i] -> [i + 23] }");
-	isl_map_free(map);
-	if (equal < 0)
+	if (test_octagon_empty(ctx) < 0)
 		return -1;
 
 	return 0;
 }
 
-int test_slice(isl_ctx *ctx)
+/* Add "pnt" to the set pointed to by "user".
+ */
+static isl_stat collect_point(__isl_take isl_point *pnt, void *user)
 {
-	const char *str;
-	isl_map *map;
-	int equal;
+	isl_set **set = user;
+
+	*set = isl_set_union(*set, isl_set_from_point(pnt));
+	return *set ? isl_stat_ok : isl_stat_error;
+}
+
+/* Check that enumerating the chunks of a set using
+ * isl_set_foreach_point_chunk enumerates the points of the set
+ * exactly once.
+ */
+static int test_foreach_point_chunk(isl_ctx *ctx)
+{
+	int n_chunk, chunk;
+	const char *str;
+	isl_set *set;
+
+	str = "{ [i, j] : 0 <= i <= 10 and 0 <= j <= i and i + j != 7; "
+		"[i, j] : 3 <= i <= 5 and j = 20 }";
+	set = isl_set_read_from_str(ctx, str);
+	for (n_chunk = 1; n_chunk <= 12; n_chunk += 3) {
+		isl_set *all;
+		int equal;
+		isl_val *n, *sum;
+
+		all = isl_set_empty(isl_set_get_space(set));
+		sum = isl_val_zero(ctx);
+		for (chunk = 0; chunk < n_chunk; ++chunk) {
+			isl_set *part;
+
+			part = isl_set_empty(isl_set_get_space(set));
+			if (isl_set_foreach_point_chunk(set, n_chunk, chunk,
+					&collect_point, &part) < 0)
+				part = isl_set_free(part);
+			sum = isl_val_add(sum, isl_set_count_val(part));
+			all = isl_set_union(all, part);
+		}
+		n = isl_set_count_val(set);
+		equal = isl_set_is_equal(all, set);
+		if (equal >= 0 && equal)
+			equal = isl_val_eq(n, sum);
+		isl_set_free(all);
+		isl_val_free(n);
+		isl_val_free(sum);
+		if (equal < 0)
+			goto error;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"chunks do not partition set", goto error);
+	}
+	isl_set_free(set);
+
+	return 0;
+error:
+	isl_set_free(set);
+	return -1;
+}
+
+int test_fixed_power(isl_ctx *ctx)
+{
+	const char *str;
+	isl_map *map;
+	isl_val *exp;
+	int equal;
+
+	str = "{ [i] -> [i + 1] }";
+	map = isl_map_read_from_str(ctx, str);
+	exp = isl_val_int_from_si(ctx, 23);
+	map = isl_map_fixed_power_val(map, exp);
+	equal = map_check_equal(map, "{ [i] -> [i + 23] }");
+	isl_map_free(map);
+	if (equal < 0)
+		return -1;
+
+	return 0;
+}
+
+int test_slice(isl_ctx *ctx)
+{
+	const char *str;
+	isl_map *map;
+	int equal;
 
 	str = "{ [i] -> [j] }";
 	map = isl_map_read_from_str(ctx, str);
@@ -5605,6 +6311,67 @@ int test_slice(isl_ctx *ctx)
 	return 0;
 }
 
+/* Rational sets from which the variables starting at "first"
+ * are eliminated, along with the number "n" of eliminated variables.
+ * The eliminations produce many combinations of three or more
+ * of the original constraints.
+ */
+struct {
+	const char *set;
+	unsigned first;
+	unsigned n;
+} eliminate_batch_tests[] = {
+	{ "{ rat: [x, y, z, w] : 0 <= x, y, z, w <= 4 and "
+	    "x + y + z + w <= 10 and x - y + z - w <= 3 and "
+	    "x + 2y - z <= 5 and 3z - w + y >= -2 and x + w - 2z <= 6 }",
+	  1, 3 },
+	{ "{ rat: [x, y, z, w, v] : -5 <= x, y, z, w, v <= 5 and "
+	    "x + y - z + w - v <= 4 and 2x - y + z + v >= -3 and "
+	    "y + 2z - w <= 7 and x - 2y - w + v <= 6 and "
+	    "z + w + v - y >= -8 and 3x + y + z - 2v <= 9 }",
+	  0, 4 },
+	{ "{ rat: [x, y, z, w] : x = y + z and 0 <= y, z, w <= 3 and "
+	    "y + z + w <= 5 and z - y + 2w >= 1 and x + w <= 6 }",
+	  1, 3 },
+};
+
+/* Check that eliminating several variables at once from the rational sets
+ * in eliminate_batch_tests gives the same result as eliminating them
+ * one at a time.  The first performs all Fourier-Motzkin steps
+ * in a single call to isl_basic_map_eliminate_vars, dropping
+ * redundant combinations based on their ancestors,
+ * while the second removes redundant constraints after each step.
+ */
+static int test_eliminate_batch(isl_ctx *ctx)
+{
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(eliminate_batch_tests); ++i) {
+		unsigned first = eliminate_batch_tests[i].first;
+		unsigned n = eliminate_batch_tests[i].n;
+		isl_set *set1, *set2;
+		isl_bool equal;
+
+		set1 = isl_set_read_from_str(ctx, eliminate_batch_tests[i].set);
+		set2 = isl_set_copy(set1);
+		set1 = isl_set_eliminate(set1, isl_dim_set, first, n);
+		for (j = n - 1; j >= 0; --j)
+			set2 = isl_set_eliminate(set2, isl_dim_set, first + j, 1);
+		equal = isl_set_is_equal(set1, set2);
+		isl_set_free(set1);
+		isl_set_free(set2);
+		if (equal < 0)
+			return -1;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"batched elimination differs from "
+				"elimination one variable at a time",
+				return -1);
+	}
+
+	return 0;
+}
+
 int test_eliminate(isl_ctx *ctx)
 {
 	const char *str;
@@ -5619,6 +6386,25 @@ int test_eliminate(isl_ctx *ctx)
 	if (equal < 0)
 		return -1;
 
+	str = "{ rat: [i] -> [j] : i <= j <= i + 1 and 0 <= i <= 10 }";
+	map = isl_map_read_from_str(ctx, str);
+	map = isl_map_eliminate(map, isl_dim_out, 0, 1);
+	equal = map_check_equal(map, "{ rat: [i] -> [j] : 0 <= i <= 10 }");
+	isl_map_free(map);
+	if (equal < 0)
+		return -1;
+
+	str = "{ rat: [i] -> [j] : 2j >= 2i + 3 and j <= i }";
+	map = isl_map_read_from_str(ctx, str);
+	map = isl_map_eliminate(map, isl_dim_out, 0, 1);
+	equal = map_check_equal(map, "{ rat: [i] -> [j] : false }");
+	isl_map_free(map);
+	if (equal < 0)
+		return -1;
+
+	if (test_eliminate_batch(ctx) < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -6452,6 +7238,98 @@ static int test_ast_gen5(isl_ctx *ctx)
 	return 0;
 }
 
+/* Generate an AST for the schedule tree described by "str"
+ * using "build" and return its C representation.
+ */
+static char *ast_gen_to_C_str(isl_ctx *ctx, __isl_keep isl_ast_build *build,
+	const char *str)
+{
+	isl_schedule *schedule;
+	isl_ast_node *tree;
+	char *s;
+
+	schedule = isl_schedule_read_from_str(ctx, str);
+	tree = isl_ast_build_node_from_schedule(build, schedule);
+	s = isl_ast_node_to_C_str(tree);
+	isl_ast_node_free(tree);
+
+	return s;
+}
+
+/* Check that an isl_ast_build created while the ast_build_cache option
+ * is set produces the same ASTs as an isl_ast_build without a cache,
+ * when it is used to generate ASTs for several schedule trees
+ * that share some of their subtrees.  Also check that the cache is used
+ * for the second generation of an AST for each schedule tree and
+ * for the subtree that is shared by the two schedule trees.
+ * Note that the schedule trees are read in again for each generation,
+ * so the cache entries need to be matched on the representation
+ * of the schedule trees rather than on the objects themselves.
+ */
+static int test_ast_gen_cache(isl_ctx *ctx)
+{
+	int i, j;
+	int cache, n_hit;
+	isl_ast_build *build, *cached_build;
+	const char *schedules[] = {
+		"domain: \"[n] -> { A[i] : 0 <= i < n; B[i,j] : 0 <= i,j < n }\"\n"
+		"child:\n"
+		"  sequence:\n"
+		"  - filter: \"{ A[i] }\"\n"
+		"    child:\n"
+		"      schedule: \"[{ A[i] -> [i] }]\"\n"
+		"  - filter: \"{ B[i,j] }\"\n"
+		"    child:\n"
+		"      schedule: \"[{ B[i,j] -> [i] }, { B[i,j] -> [j] }]\"\n",
+		"domain: \"[n] -> { A[i] : 0 <= i < n; B[i,j] : 0 <= i,j < n }\"\n"
+		"child:\n"
+		"  sequence:\n"
+		"  - filter: \"{ A[i] }\"\n"
+		"    child:\n"
+		"      schedule: \"[{ A[i] -> [i] }]\"\n"
+		"  - filter: \"{ B[i,j] }\"\n"
+		"    child:\n"
+		"      schedule: \"[{ B[i,j] -> [floor(i/4)] }, "
+					"{ B[i,j] -> [j] }]\"\n"
+		"      child:\n"
+		"        schedule: \"[{ B[i,j] -> [i] }]\"\n",
+	};
+
+	cache = isl_options_get_ast_build_cache(ctx);
+	isl_options_set_ast_build_cache(ctx, 0);
+	build = isl_ast_build_alloc(ctx);
+	isl_options_set_ast_build_cache(ctx, 1);
+	cached_build = isl_ast_build_alloc(ctx);
+	isl_options_set_ast_build_cache(ctx, cache);
+
+	for (i = 0; i < 2 * ARRAY_SIZE(schedules); ++i) {
+		char *s1, *s2;
+		int equal;
+
+		j = i % ARRAY_SIZE(schedules);
+		s1 = ast_gen_to_C_str(ctx, build, schedules[j]);
+		s2 = ast_gen_to_C_str(ctx, cached_build, schedules[j]);
+		equal = s1 && s2 && !strcmp(s1, s2);
+		free(s1);
+		free(s2);
+		if (!equal)
+			break;
+	}
+
+	n_hit = isl_ast_build_cache_get_n_hit(cached_build);
+	isl_ast_build_free(build);
+	isl_ast_build_free(cached_build);
+
+	if (i < 2 * ARRAY_SIZE(schedules))
+		isl_die(ctx, isl_error_unknown,
+			"cached AST differs from uncached AST", return -1);
+	if (n_hit < ARRAY_SIZE(schedules) + 1)
+		isl_die(ctx, isl_error_unknown,
+			"expecting cache hits", return -1);
+
+	return 0;
+}
+
 /* Check that the expression
  *
  *	[n] -> { [n/2] : n <= 0 and n % 2 = 0; [0] : n > 0 }
@@ -6495,6 +7373,97 @@ static int test_ast_expr(isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that isl_ast_build_expr_from_pw_qpolynomial refuses
+ * to construct an AST expression for a piecewise quasi-polynomial
+ * with a NaN or infinite piece.
+ */
+static int test_ast_expr_qp_special(isl_ctx *ctx)
+{
+	int i, on_error;
+	isl_space *space;
+	isl_set *dom;
+	isl_qpolynomial *qp;
+	isl_pw_qpolynomial *pwqp;
+	isl_ast_build *build;
+	isl_ast_expr *expr;
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	for (i = 0; i < 3; ++i) {
+		dom = isl_set_read_from_str(ctx, "[n] -> { : n >= 0 }");
+		space = isl_set_get_space(dom);
+		if (i == 0)
+			qp = isl_qpolynomial_nan_on_domain(space);
+		else if (i == 1)
+			qp = isl_qpolynomial_infty_on_domain(space);
+		else
+			qp = isl_qpolynomial_neginfty_on_domain(space);
+		pwqp = isl_pw_qpolynomial_alloc(dom, qp);
+		build = isl_ast_build_alloc(ctx);
+		expr = isl_ast_build_expr_from_pw_qpolynomial(build, pwqp);
+		isl_ast_build_free(build);
+		isl_ast_expr_free(expr);
+		if (expr)
+			break;
+	}
+	isl_options_set_on_error(ctx, on_error);
+	isl_ctx_reset_error(ctx);
+
+	if (i < 3)
+		isl_die(ctx, isl_error_unknown,
+			"AST expression not expected for NaN or infinity",
+			return -1);
+
+	return 0;
+}
+
+/* Check that isl_ast_build_expr_from_pw_qpolynomial produces
+ * the expected AST expressions.
+ */
+static int test_ast_expr_qp(isl_ctx *ctx)
+{
+	int i;
+	struct {
+		const char *pwqp;
+		const char *expr;
+	} tests[] = {
+		{ "[n] -> { 1/2 * n^2 + 1/2 * n : n >= 0 }",
+		  "n >= 0 ? (n + 1) * n / 2 : 0" },
+		{ "[n] -> { 3 * n^2 - n + 1 }", "(3 * n - 1) * n + 1" },
+		{ "[n] -> { n : n >= 0; 1 - n : n < 0 }",
+		  "n >= 0 ? n : -n + 1" },
+		{ "[n] -> { floor(n/3) * n }", "n * floord(n, 3)" },
+		{ "[n] -> { 0 }", "0" },
+	};
+
+	for (i = 0; i < ARRAY_SIZE(tests); ++i) {
+		isl_pw_qpolynomial *pwqp;
+		isl_ast_build *build;
+		isl_ast_expr *expr;
+		char *str;
+		int equal;
+
+		pwqp = isl_pw_qpolynomial_read_from_str(ctx, tests[i].pwqp);
+		build = isl_ast_build_alloc(ctx);
+		expr = isl_ast_build_expr_from_pw_qpolynomial(build, pwqp);
+		isl_ast_build_free(build);
+		str = isl_ast_expr_to_C_str(expr);
+		isl_ast_expr_free(expr);
+		if (!str)
+			return -1;
+		equal = !strcmp(str, tests[i].expr);
+		free(str);
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected AST expression", return -1);
+	}
+
+	if (test_ast_expr_qp_special(ctx) < 0)
+		return -1;
+
+	return 0;
+}
+
 static int test_ast_gen(isl_ctx *ctx)
 {
 	if (test_ast_gen1(ctx) < 0)
@@ -6507,8 +7476,12 @@ static int test_ast_gen(isl_ctx *ctx)
 		return -1;
 	if (test_ast_gen5(ctx) < 0)
 		return -1;
+	if (test_ast_gen_cache(ctx) < 0)
+		return -1;
 	if (test_ast_expr(ctx) < 0)
 		return -1;
+	if (test_ast_expr_qp(ctx) < 0)
+		return -1;
 	return 0;
 }
 
@@ -6643,6 +7616,79 @@ static int test_simplify_2(isl_ctx *ctx)
 	return 0;
 }
 
+/* isl_basic_set_foreach_constraint callback that increments
+ * the counter pointed to by "user" for each inequality constraint.
+ */
+static isl_stat count_inequality(__isl_take isl_constraint *c, void *user)
+{
+	int *n = user;
+
+	if (!isl_constraint_is_equality(c))
+		(*n)++;
+	isl_constraint_free(c);
+	return isl_stat_ok;
+}
+
+/* Inputs for test_simplify_3.
+ * Each input consists of a description of a basic set in terms
+ * of pairs of opposite inequalities and
+ * an equivalent description in terms of equalities.
+ * In the second input, the pairs are nested, such that
+ * the first constraint of a pair appears after the first constraint
+ * of another pair, while its second constraint appears before
+ * the second constraint of that other pair.
+ */
+static struct {
+	const char *ineq;
+	const char *eq;
+} simplify_3_tests[] = {
+	{ "{ [i, j, k, l] : i >= 0 and -i >= 0 and j - 1 >= 0 and "
+		"1 - j >= 0 and k - i - j - 1 >= 0 and i + j + 1 - k >= 0 and "
+		"2l - k >= 0 and k - 2l >= 0 }",
+	  "{ [0, 1, 2, 1] }" },
+	{ "{ [a, b, c] : a - 1 >= 0 and b - c >= 0 and c - 2 >= 0 and "
+		"2 - c >= 0 and c - b >= 0 and 1 - a >= 0 }",
+	  "{ [1, 2, 2] }" },
+};
+
+/* Check that all pairs of opposite inequalities in the inputs
+ * of simplify_3_tests are turned into equalities and
+ * that the result is equal to the expected result.
+ */
+static int test_simplify_3(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(simplify_3_tests); ++i) {
+		isl_basic_set *bset, *expected;
+		int n_ineq = 0;
+		isl_stat r;
+		isl_bool equal;
+
+		bset = isl_basic_set_read_from_str(ctx,
+						simplify_3_tests[i].ineq);
+		expected = isl_basic_set_read_from_str(ctx,
+						simplify_3_tests[i].eq);
+		r = isl_basic_set_foreach_constraint(bset,
+						&count_inequality, &n_ineq);
+		equal = isl_basic_set_is_equal(bset, expected);
+		isl_basic_set_free(bset);
+		isl_basic_set_free(expected);
+
+		if (r < 0 || equal < 0)
+			return -1;
+		if (n_ineq != 0)
+			isl_die(ctx, isl_error_unknown,
+				"inequality pairs not turned into equalities",
+				return -1);
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected result", return -1);
+	}
+
+	return 0;
+}
+
 /* Some simplification tests.
  */
 static int test_simplify(isl_ctx *ctx)
@@ -6651,6 +7697,8 @@ static int test_simplify(isl_ctx *ctx)
 		return -1;
 	if (test_simplify_2(ctx) < 0)
 		return -1;
+	if (test_simplify_3(ctx) < 0)
+		return -1;
 	return 0;
 }
 
@@ -7093,6 +8141,67 @@ static int test_universe(isl_ctx *ctx)
 	return 0;
 }
 
+/* Is "bset" equal to the basic set described by "str"?
+ */
+static isl_bool basic_set_is_equal_to_str(__isl_keep isl_basic_set *bset,
+	const char *str)
+{
+	isl_basic_set *expected;
+	isl_bool equal;
+
+	expected = isl_basic_set_read_from_str(isl_basic_set_get_ctx(bset),
+						str);
+	equal = isl_basic_set_is_equal(bset, expected);
+	isl_basic_set_free(expected);
+
+	return equal;
+}
+
+/* Check that a basic set that shares its constraints with another
+ * basic set that only differs in the name of its space
+ * can be modified without affecting the other basic set and vice versa.
+ */
+static int test_shared_constraints(isl_ctx *ctx)
+{
+	const char *str;
+	isl_basic_set *bset, *named, *copy;
+	isl_bool equal;
+
+	str = "{ [i, j] : exists a : 0 <= i <= 10 and 0 <= j <= i and "
+		"j = 2a }";
+	bset = isl_basic_set_read_from_str(ctx, str);
+	named = isl_basic_set_set_tuple_name(isl_basic_set_copy(bset), "A");
+	copy = isl_basic_set_copy(named);
+	str = "{ A[i, j] : i >= 5 }";
+	named = isl_basic_set_intersect(named,
+				isl_basic_set_read_from_str(ctx, str));
+	str = "{ [i, j] : j >= 7 }";
+	bset = isl_basic_set_intersect(bset,
+				isl_basic_set_read_from_str(ctx, str));
+
+	str = "{ [i, j] : exists a : 7 <= j <= i <= 10 and j = 2a }";
+	equal = basic_set_is_equal_to_str(bset, str);
+	str = "{ A[i, j] : exists a : 5 <= i <= 10 and 0 <= j <= i and "
+		"j = 2a }";
+	if (equal >= 0 && equal)
+		equal = basic_set_is_equal_to_str(named, str);
+	str = "{ A[i, j] : exists a : 0 <= i <= 10 and 0 <= j <= i and "
+		"j = 2a }";
+	if (equal >= 0 && equal)
+		equal = basic_set_is_equal_to_str(copy, str);
+	isl_basic_set_free(bset);
+	isl_basic_set_free(named);
+	isl_basic_set_free(copy);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"shared constraints modified", return -1);
+
+	return 0;
+}
+
 /* Sets for which chambers are computed and checked.
  */
 const char *chambers_tests[] = {
@@ -7181,15 +8290,284 @@ static int test_chambers(isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that array allocations with a number of elements
+ * for which the total size does not fit in a size_t are refused,
+ * rather than allocating the wrapped-around size.
+ */
+static int test_alloc_overflow(isl_ctx *ctx)
+{
+	int on_error;
+	size_t n;
+	double *p1, *p2, *p3;
+
+	n = SIZE_MAX / sizeof(double) + 2;
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	p1 = isl_alloc_array(ctx, double, n);
+	p2 = isl_calloc_array(ctx, double, n);
+	p3 = isl_realloc_array(ctx, NULL, double, n);
+	isl_options_set_on_error(ctx, on_error);
+	isl_ctx_reset_error(ctx);
+
+	free(p1);
+	free(p2);
+	free(p3);
+	if (p1 || p2 || p3)
+		isl_die(ctx, isl_error_unknown,
+			"overflowing allocation not expected to succeed",
+			return -1);
+
+	return 0;
+}
+
+/* Check that an allocation that does not fit in the memory budget
+ * of "ctx" fails with isl_error_quota and that the tracked memory usage
+ * is restored after the failure.
+ */
+static int test_memory_quota(isl_ctx *ctx)
+{
+	int on_error;
+	unsigned long memory, max_memory;
+	isl_mat *mat;
+	enum isl_error error;
+
+	memory = isl_ctx_get_memory(ctx);
+	max_memory = isl_ctx_get_max_memory(ctx);
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	isl_ctx_reset_error(ctx);
+	isl_ctx_set_max_memory(ctx, memory + 1000);
+	mat = isl_mat_alloc(ctx, 1000, 1000);
+	error = isl_ctx_last_error(ctx);
+	isl_mat_free(mat);
+	isl_ctx_set_max_memory(ctx, max_memory);
+	isl_ctx_reset_error(ctx);
+	isl_options_set_on_error(ctx, on_error);
+
+	if (mat)
+		isl_die(ctx, isl_error_unknown,
+			"allocation not expected to succeed", return -1);
+	if (error != isl_error_quota)
+		isl_die(ctx, isl_error_unknown,
+			"expecting quota error", return -1);
+	if (isl_ctx_get_memory(ctx) > memory)
+		isl_die(ctx, isl_error_unknown,
+			"memory not released", return -1);
+
+	if (test_alloc_overflow(ctx) < 0)
+		return -1;
+
+	mat = isl_mat_alloc(ctx, 100, 100);
+	if (!mat)
+		return -1;
+	memory = isl_ctx_get_memory(ctx);
+	isl_mat_free(mat);
+	if (isl_ctx_get_peak_memory(ctx) < memory)
+		isl_die(ctx, isl_error_unknown,
+			"peak memory smaller than current memory", return -1);
+
+	return 0;
+}
+
+/* Construct a random non-singular "n" by "n" matrix
+ * as the product of a unit lower triangular matrix, a diagonal matrix
+ * with non-zero (and mostly non-unit) diagonal elements and
+ * a unit upper triangular matrix.
+ */
+static __isl_give isl_mat *random_non_singular(isl_ctx *ctx, int n)
+{
+	int i, j;
+	isl_mat *lower, *diag, *upper;
+
+	lower = isl_mat_alloc(ctx, n, n);
+	diag = isl_mat_alloc(ctx, n, n);
+	upper = isl_mat_alloc(ctx, n, n);
+	for (i = 0; i < n; ++i) {
+		int d = test_random(3);
+
+		for (j = 0; j < n; ++j) {
+			int l = i > j ? test_random(3) : i == j;
+			int u = i < j ? test_random(3) : i == j;
+
+			lower = isl_mat_set_element_si(lower, i, j, l);
+			upper = isl_mat_set_element_si(upper, i, j, u);
+			diag = isl_mat_set_element_si(diag, i, j,
+						i != j ? 0 : d ? d : 2);
+		}
+	}
+
+	return isl_mat_product(isl_mat_product(lower, diag), upper);
+}
+
+/* Construct a random "n_row" by "n_col" matrix.
+ */
+static __isl_give isl_mat *random_mat(isl_ctx *ctx, int n_row, int n_col)
+{
+	int i, j;
+	isl_mat *mat;
+
+	mat = isl_mat_alloc(ctx, n_row, n_col);
+	for (i = 0; i < n_row; ++i)
+		for (j = 0; j < n_col; ++j)
+			mat = isl_mat_set_element_si(mat, i, j,
+						test_random(5));
+
+	return mat;
+}
+
+/* Is "mat1" equal to a positive rational multiple of "mat2"?
+ * "mat1" and "mat2" are assumed to have the same dimensions.
+ * If so and if "f" is not NULL, then set *f to the positive factor
+ * such that "mat1" is equal to *f times "mat2".
+ * If "mat2" is zero, then this factor is taken to be one.
+ */
+static isl_bool mat_is_positive_multiple(__isl_keep isl_mat *mat1,
+	__isl_keep isl_mat *mat2, __isl_give isl_val **f)
+{
+	int i, j, n_row, n_col;
+	isl_val *v1 = NULL, *v2 = NULL;
+	isl_bool res = isl_bool_true;
+
+	n_row = isl_mat_rows(mat1);
+	n_col = isl_mat_cols(mat1);
+	for (i = 0; res == isl_bool_true && i < n_row; ++i) {
+		for (j = 0; res == isl_bool_true && j < n_col; ++j) {
+			isl_val *a, *b;
+
+			a = isl_mat_get_element_val(mat1, i, j);
+			b = isl_mat_get_element_val(mat2, i, j);
+			if (!a || !b) {
+				res = isl_bool_error;
+			} else if (!v1 && !isl_val_is_zero(b)) {
+				v1 = isl_val_copy(a);
+				v2 = isl_val_copy(b);
+				if (isl_val_sgn(a) != isl_val_sgn(b))
+					res = isl_bool_false;
+			} else {
+				if (v1) {
+					a = isl_val_mul(a, isl_val_copy(v2));
+					b = isl_val_mul(b, isl_val_copy(v1));
+				}
+				res = isl_val_eq(a, b);
+			}
+			isl_val_free(a);
+			isl_val_free(b);
+		}
+	}
+
+	if (res == isl_bool_true && f)
+		*f = v1 ? isl_val_div(isl_val_copy(v1), isl_val_copy(v2)) :
+			isl_val_one(isl_mat_get_ctx(mat1));
+	isl_val_free(v1);
+	isl_val_free(v2);
+
+	return res;
+}
+
+/* Check that "prod" is the result of isl_mat_inverse_product
+ * on "left" and "right", i.e., that "prod" is equal to
+ * inv(left)*right multiplied by the smallest positive integer
+ * that makes it integral.
+ * In particular, check that left*prod is a positive integer multiple
+ * of "right" and that the factor has no common divisor
+ * with all elements of "prod".
+ *
+ * Additionally, compare "prod" to the result of computing
+ * the inverse of "left" through the column elimination
+ * in isl_mat_right_inverse.  This function only applies
+ * this elimination to non-square matrices, so "left" is extended
+ * with a zero column.  The top left square block of the result
+ * is then a multiple of the inverse of "left".
+ */
+static isl_stat check_inverse_product(__isl_keep isl_mat *left,
+	__isl_keep isl_mat *right, __isl_keep isl_mat *prod)
+{
+	int i, j, n, n_col;
+	isl_ctx *ctx;
+	isl_mat *lp, *inv;
+	isl_val *f = NULL;
+	isl_bool ok;
+
+	ctx = isl_mat_get_ctx(left);
+	n = isl_mat_rows(left);
+	n_col = isl_mat_cols(right);
+	lp = isl_mat_product(isl_mat_copy(left), isl_mat_copy(prod));
+	ok = mat_is_positive_multiple(lp, right, &f);
+	isl_mat_free(lp);
+	if (ok == isl_bool_true)
+		ok = isl_val_is_int(f);
+	for (i = 0; ok == isl_bool_true && i < n; ++i)
+		for (j = 0; j < n_col; ++j)
+			f = isl_val_gcd(f, isl_mat_get_element_val(prod, i, j));
+	if (ok == isl_bool_true)
+		ok = isl_val_is_one(f);
+	isl_val_free(f);
+	if (ok < 0)
+		return isl_stat_error;
+	if (!ok)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected inverse product", return isl_stat_error);
+
+	inv = isl_mat_add_zero_cols(isl_mat_copy(left), 1);
+	inv = isl_mat_right_inverse(inv);
+	inv = isl_mat_drop_rows(inv, n, 1);
+	inv = isl_mat_drop_cols(inv, n, 1);
+	inv = isl_mat_product(inv, isl_mat_copy(right));
+	ok = inv ? mat_is_positive_multiple(inv, prod, NULL) : isl_bool_error;
+	isl_mat_free(inv);
+	if (ok < 0)
+		return isl_stat_error;
+	if (!ok)
+		isl_die(ctx, isl_error_unknown,
+			"inverse product differs from column elimination",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
+/* Check isl_mat_inverse_product on a collection of pseudo-random
+ * non-singular matrices of different sizes,
+ * most of which are not unimodular.
+ */
+static int test_inverse_product(isl_ctx *ctx)
+{
+	int i;
+
+	test_random_seed(1);
+	for (i = 0; i < 200; ++i) {
+		int n = 1 + i % 6;
+		int n_col = 1 + (i / 6) % 3;
+		isl_mat *left, *right, *prod;
+		isl_stat r;
+
+		left = random_non_singular(ctx, n);
+		right = random_mat(ctx, n, n_col);
+		prod = isl_mat_inverse_product(isl_mat_copy(left),
+						isl_mat_copy(right));
+		r = prod ? check_inverse_product(left, right, prod) :
+			isl_stat_error;
+		isl_mat_free(left);
+		isl_mat_free(right);
+		isl_mat_free(prod);
+		if (r < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
 struct {
 	const char *name;
 	int (*fn)(isl_ctx *ctx);
 } tests [] = {
+	{ "memory quota", &test_memory_quota },
 	{ "universe", &test_universe },
+	{ "shared constraints", &test_shared_constraints },
 	{ "domain hash", &test_domain_hash },
 	{ "dual", &test_dual },
 	{ "dependence analysis", &test_flow },
 	{ "val", &test_val },
+	{ "matrix inverse product", &test_inverse_product },
 	{ "compute divs", &test_compute_divs },
 	{ "partial lexmin", &test_partial_lexmin },
 	{ "simplify", &test_simplify },
@@ -7210,6 +8588,7 @@ struct {
 	{ "slice", &test_slice },
 	{ "fixed power", &test_fixed_power },
 	{ "sample", &test_sample },
+	{ "point chunks", &test_foreach_point_chunk },
 	{ "output", &test_output },
 	{ "vertices", &test_vertices },
 	{ "chambers", &test_chambers },
@@ -7253,6 +8632,7 @@ struct {
 	{ "map application", &test_application },
 	{ "convex hull", &test_convex_hull },
 	{ "transitive closure", &test_closure },
+	{ "closure cache", &test_closure_cache },
 };
 
 int main(int argc, char **argv)
@@ -1981,6 +1981,211 @@ static __isl_give isl_map *construct_power(__isl_keep isl_map *map,
 	return app;
 }
 
+#define ISL_CLOSURE_CACHE_SIZE	64
+
+/* The number of options that are taken into account
+ * by the closure cache.  See get_closure_options.
+ */
+#define ISL_CLOSURE_CACHE_N_OPT	3
+
+/* Store the values of the options of "ctx" that affect the result
+ * of map_power in "opt".
+ * These are the choice of algorithm and the options that affect
+ * the convex hulls and the coalescing computed along the way.
+ */
+static void get_closure_options(isl_ctx *ctx,
+	int opt[ISL_CLOSURE_CACHE_N_OPT])
+{
+	opt[0] = ctx->opt->closure;
+	opt[1] = ctx->opt->convex;
+	opt[2] = ctx->opt->coalesce_bounded_wrapping;
+}
+
+/* An entry in the cache of results of map_power.
+ * "map" is the input of map_power, while "project" and "want_exact"
+ * are the value of the "project" argument and whether or not
+ * the caller was interested in the exactness of the result.
+ * "opt" contains the values of the options that affect the result
+ * at the time it was computed.
+ * "power" is the result of map_power and "exact" is set
+ * if this result is known to be exact.
+ */
+struct isl_closure_cache_entry {
+	isl_map *map;
+	int project;
+	int want_exact;
+	int opt[ISL_CLOSURE_CACHE_N_OPT];
+
+	isl_map *power;
+	int exact;
+};
+
+/* A cache of results of map_power, attached to an isl_ctx.
+ * "n" is the number of valid entries.
+ * Once the cache is full, the entries are replaced in the order
+ * in which they were added, with "next" the position
+ * of the next entry that will be replaced.
+ * "n_hit" is the number of times a result was found in the cache.
+ */
+struct isl_closure_cache {
+	int n;
+	int next;
+	int n_hit;
+	struct isl_closure_cache_entry entry[ISL_CLOSURE_CACHE_SIZE];
+};
+
+/* Free all entries in the closure cache of "ctx" along with
+ * the cache itself.
+ * This is called when the isl_ctx is freed and when
+ * the closure_cache option is turned off, but it may also be
+ * called by the user to release the memory held by the cache.
+ */
+void isl_ctx_clear_closure_cache(isl_ctx *ctx)
+{
+	int i;
+	struct isl_closure_cache *cache;
+
+	if (!ctx || !ctx->closure_cache)
+		return;
+
+	cache = ctx->closure_cache;
+	ctx->closure_cache = NULL;
+	for (i = 0; i < cache->n; ++i) {
+		isl_map_free(cache->entry[i].map);
+		isl_map_free(cache->entry[i].power);
+	}
+	free(cache);
+}
+
+/* Return the number of times a result was found in the closure cache
+ * of "ctx" since the cache was last cleared.
+ */
+int isl_ctx_get_closure_cache_n_hit(isl_ctx *ctx)
+{
+	if (!ctx)
+		return -1;
+	if (!ctx->closure_cache)
+		return 0;
+	return ctx->closure_cache->n_hit;
+}
+
+/* Look for a previously computed result of map_power on "map"
+ * with the same "project" argument, the same interest in exactness and
+ * the same values of the options that affect the result.
+ * If one is found, then return a copy and set *exact (if not NULL).
+ * Otherwise, return NULL.
+ *
+ * The input map is compared to the cached inputs without normalizing
+ * either of them, such that a lookup does not modify the representation
+ * of "map" and a cached result is identical to the result
+ * that would have been computed.
+ */
+static __isl_give isl_map *closure_cache_find(__isl_keep isl_map *map,
+	int *exact, int project)
+{
+	int i, j;
+	int opt[ISL_CLOSURE_CACHE_N_OPT];
+	struct isl_closure_cache *cache;
+
+	cache = map->ctx->closure_cache;
+	if (!cache)
+		return NULL;
+
+	get_closure_options(map->ctx, opt);
+	for (i = 0; i < cache->n; ++i) {
+		struct isl_closure_cache_entry *entry = &cache->entry[i];
+		isl_bool identical;
+
+		if (entry->project != project || entry->want_exact != !!exact)
+			continue;
+		for (j = 0; j < ISL_CLOSURE_CACHE_N_OPT; ++j)
+			if (entry->opt[j] != opt[j])
+				break;
+		if (j < ISL_CLOSURE_CACHE_N_OPT)
+			continue;
+		identical = isl_map_plain_is_identical(entry->map, map);
+		if (identical < 0)
+			return NULL;
+		if (!identical)
+			continue;
+		if (exact)
+			*exact = entry->exact;
+		cache->n_hit++;
+		return isl_map_copy(entry->power);
+	}
+
+	return NULL;
+}
+
+/* Return a copy of "map" that does not share any basic maps with "map".
+ * The computation of the power of "map" may modify the representation
+ * of its basic maps in place, while the closure cache needs to keep
+ * the representation of the input as it was passed to map_power.
+ */
+static __isl_give isl_map *closure_cache_key(__isl_keep isl_map *map)
+{
+	int i;
+	isl_map *key;
+
+	if (!map)
+		return NULL;
+
+	key = isl_map_alloc_space(isl_map_get_space(map), map->n, map->flags);
+	for (i = 0; i < map->n; ++i)
+		key = isl_map_add_basic_map(key,
+					    isl_basic_map_dup(map->p[i]));
+
+	return key;
+}
+
+/* Add the result "power" of applying map_power to "key" to the closure
+ * cache of the isl_ctx, allocating the cache if needed.
+ * "key" is a copy of the input of map_power as constructed
+ * by closure_cache_key.
+ * "exact" is the (possibly NULL) pointer that was passed to map_power.
+ * If the cache is full, then the oldest entry is replaced.
+ */
+static isl_stat closure_cache_add(__isl_take isl_map *key,
+	__isl_keep isl_map *power, int *exact, int project)
+{
+	isl_ctx *ctx;
+	struct isl_closure_cache *cache;
+	struct isl_closure_cache_entry *entry;
+
+	if (!key || !power)
+		goto error;
+
+	ctx = isl_map_get_ctx(key);
+	if (!ctx->closure_cache) {
+		ctx->closure_cache = isl_calloc_type(ctx,
+						struct isl_closure_cache);
+		if (!ctx->closure_cache)
+			goto error;
+	}
+	cache = ctx->closure_cache;
+
+	if (cache->n < ISL_CLOSURE_CACHE_SIZE) {
+		entry = &cache->entry[cache->n++];
+	} else {
+		entry = &cache->entry[cache->next];
+		cache->next = (cache->next + 1) % ISL_CLOSURE_CACHE_SIZE;
+		isl_map_free(entry->map);
+		isl_map_free(entry->power);
+	}
+
+	entry->map = key;
+	entry->project = project;
+	entry->want_exact = !!exact;
+	get_closure_options(ctx, entry->opt);
+	entry->power = isl_map_copy(power);
+	entry->exact = exact ? *exact : 0;
+
+	return isl_stat_ok;
+error:
+	isl_map_free(key);
+	return isl_stat_error;
+}
+
 /* Compute the positive powers of "map", or an overapproximation.
  * If the result is exact, then *exact is set to 1.
  *
@@ -1988,11 +2193,16 @@ static __isl_give isl_map *construct_power(__isl_keep isl_map *map,
  * closure, so we can use a more relaxed exactness check.
  * The lengths of the paths are also projected out instead of being
  * encoded as the difference between an extra pair of final coordinates.
+ *
+ * If the closure_cache option is set, then the result is looked up
+ * in and added to the closure cache of the isl_ctx.
  */
 static __isl_give isl_map *map_power(__isl_take isl_map *map,
 	int *exact, int project)
 {
 	struct isl_map *app = NULL;
+	isl_map *key = NULL;
+	int use_cache;
 
 	if (exact)
 		*exact = 1;
@@ -2004,8 +2214,25 @@ static __isl_give isl_map *map_power(__isl_take isl_map *map,
 		isl_map_dim(map, isl_dim_in) == isl_map_dim(map, isl_dim_out),
 		goto error);
 
+	use_cache = map->ctx->opt->closure_cache;
+	if (use_cache) {
+		app = closure_cache_find(map, exact, project);
+		if (app) {
+			isl_map_free(map);
+			return app;
+		}
+		key = closure_cache_key(map);
+		if (!key)
+			goto error;
+	}
+
 	app = construct_power(map, exact, project);
 
+	if (!app)
+		key = isl_map_free(key);
+	if (key && closure_cache_add(key, app, exact, project) < 0)
+		goto error;
+
 	isl_map_free(map);
 	return app;
 error:
@@ -2280,6 +2280,110 @@ isl_bool isl_union_set_is_subset(__isl_keep isl_union_set *uset1,
 	return isl_union_map_is_subset(uset1, uset2);
 }
 
+/* Internal data structure for isl_union_map_plain_is_identical.
+ * "umap2" is the union map with which the elements of the other
+ * union map are being compared.
+ * "identical" is set to false as soon as a difference is found.
+ */
+struct isl_union_map_plain_is_identical_data {
+	isl_union_map *umap2;
+	isl_bool identical;
+};
+
+/* Is the map in "entry" represented in exactly the same way
+ * as the map with the same space in data->umap2?
+ */
+static isl_stat is_identical_entry(void **entry, void *user)
+{
+	struct isl_union_map_plain_is_identical_data *data = user;
+	uint32_t hash;
+	struct isl_hash_table_entry *entry2;
+	isl_map *map = *entry;
+
+	hash = isl_space_get_hash(map->dim);
+	entry2 = isl_hash_table_find(data->umap2->dim->ctx, &data->umap2->table,
+				     hash, &has_space, map->dim, 0);
+	if (!entry2) {
+		data->identical = isl_bool_false;
+		return isl_stat_error;
+	}
+
+	data->identical = isl_map_plain_is_identical(map, entry2->data);
+	if (data->identical < 0 || !data->identical)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Are "umap1" and "umap2" represented in exactly the same way?
+ * That is, do they have the same parameters and do they contain
+ * maps in the same spaces that are represented in exactly the same way?
+ * See isl_map_plain_is_identical.
+ */
+isl_bool isl_union_map_plain_is_identical(__isl_keep isl_union_map *umap1,
+	__isl_keep isl_union_map *umap2)
+{
+	struct isl_union_map_plain_is_identical_data data =
+						{ NULL, isl_bool_true };
+	isl_bool equal;
+
+	if (!umap1 || !umap2)
+		return isl_bool_error;
+	if (umap1 == umap2)
+		return isl_bool_true;
+	equal = isl_space_is_equal(umap1->dim, umap2->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	if (umap1->table.n != umap2->table.n)
+		return isl_bool_false;
+
+	data.umap2 = umap2;
+	if (isl_hash_table_foreach(umap1->dim->ctx, &umap1->table,
+				   &is_identical_entry, &data) < 0 &&
+	    data.identical)
+		return isl_bool_error;
+
+	return data.identical;
+}
+
+/* Add the hash value of the representation of the map in "entry"
+ * to *hash.
+ * The hash values are combined through addition since the order
+ * in which the maps are visited depends on the history of "umap".
+ */
+static isl_stat add_plain_hash(void **entry, void *user)
+{
+	uint32_t *hash = user;
+	isl_map *map = *entry;
+
+	*hash += isl_map_plain_get_hash(map);
+
+	return isl_stat_ok;
+}
+
+/* Return a hash value that digests the representation of "umap",
+ * without normalizing the maps it contains.
+ * Union maps that are considered identical
+ * by isl_union_map_plain_is_identical have the same hash value.
+ */
+uint32_t isl_union_map_plain_get_hash(__isl_keep isl_union_map *umap)
+{
+	uint32_t hash, space_hash, maps = 0;
+
+	if (!umap)
+		return 0;
+
+	if (isl_hash_table_foreach(umap->dim->ctx, &umap->table,
+				   &add_plain_hash, &maps) < 0)
+		return 0;
+	hash = isl_hash_init();
+	space_hash = isl_space_get_hash(umap->dim);
+	isl_hash_hash(hash, space_hash);
+	isl_hash_hash(hash, maps);
+
+	return hash;
+}
+
 isl_bool isl_union_map_is_equal(__isl_keep isl_union_map *umap1,
 	__isl_keep isl_union_map *umap2)
 {
@@ -12,5 +12,8 @@ struct isl_union_map {
 
 isl_bool isl_union_map_space_has_equal_params(__isl_keep isl_union_map *umap,
 	__isl_keep isl_space *space);
+isl_bool isl_union_map_plain_is_identical(__isl_keep isl_union_map *umap1,
+	__isl_keep isl_union_map *umap2);
+uint32_t isl_union_map_plain_get_hash(__isl_keep isl_union_map *umap);
 __isl_give isl_union_map *isl_union_map_reset_range_space(
 	__isl_take isl_union_map *umap, __isl_take isl_space *space);
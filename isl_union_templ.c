@@ -1031,6 +1031,70 @@ error:
 	return isl_bool_error;
 }
 
+/* Is the element that "entry" points to represented in exactly
+ * the same way as the element with the same space in data->u2?
+ */
+static isl_stat FN(UNION,plain_is_identical_entry)(void **entry, void *user)
+{
+	S(UNION,plain_is_equal_data) *data = user;
+	struct isl_hash_table_entry *entry2;
+	PW *pw = *entry;
+
+	entry2 = FN(UNION,find_part_entry)(data->u2, pw->dim, 0);
+	if (!entry2 || entry2 == isl_hash_table_entry_none) {
+		if (!entry2)
+			data->is_equal = isl_bool_error;
+		else
+			data->is_equal = isl_bool_false;
+		return isl_stat_error;
+	}
+
+	data->is_equal = FN(PW,plain_is_identical)(pw, entry2->data);
+	if (data->is_equal < 0 || !data->is_equal)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Are "u1" and "u2" represented in exactly the same way?
+ * That is, do they have the same parameters and do they contain
+ * base expressions in the same spaces that are represented in exactly
+ * the same way?
+ * Unlike UNION,plain_is_equal, this function does not align
+ * the parameters or normalize the base expressions.
+ */
+isl_bool FN(UNION,plain_is_identical)(__isl_keep UNION *u1,
+	__isl_keep UNION *u2)
+{
+	S(UNION,plain_is_equal_data) data = { NULL, isl_bool_true };
+	isl_bool equal;
+	int n1, n2;
+
+	if (!u1 || !u2)
+		return isl_bool_error;
+	if (u1 == u2)
+		return isl_bool_true;
+	equal = isl_space_is_equal(u1->space, u2->space);
+	if (equal < 0 || !equal)
+		return equal;
+	if (u1->table.n != u2->table.n)
+		return isl_bool_false;
+	n1 = FN(FN(UNION,n),PARTS)(u1);
+	n2 = FN(FN(UNION,n),PARTS)(u2);
+	if (n1 < 0 || n2 < 0)
+		return isl_bool_error;
+	if (n1 != n2)
+		return isl_bool_false;
+
+	data.u2 = u2;
+	if (FN(UNION,foreach_inplace)(u1,
+			&FN(UNION,plain_is_identical_entry), &data) < 0 &&
+	    data.is_equal)
+		return isl_bool_error;
+
+	return data.is_equal;
+}
+
 /* Check whether the element that "entry" points to involves any NaNs and
  * store the result in *nan.
  * Abort as soon as one such element has been found.
@@ -509,19 +509,48 @@ static void free_chamber_list(struct isl_chamber_list *list)
 	}
 }
 
+/* Is the inequality constraint "ineq" trivially satisfied by
+ * all elements of "bset" because it appears among the constraints
+ * of "bset", either as an inequality constraint or as one of the two
+ * inequality constraints making up an equality constraint?
+ */
+static int bset_plain_has_ineq(__isl_keep isl_basic_set *bset, isl_int *ineq)
+{
+	int i;
+	unsigned total;
+
+	total = isl_basic_set_total_dim(bset);
+	for (i = 0; i < bset->n_eq; ++i)
+		if (isl_seq_eq(bset->eq[i], ineq, 1 + total) ||
+		    isl_seq_is_neg(bset->eq[i], ineq, 1 + total))
+			return 1;
+	for (i = 0; i < bset->n_ineq; ++i)
+		if (isl_seq_eq(bset->ineq[i], ineq, 1 + total))
+			return 1;
+
+	return 0;
+}
+
 /* Check whether the basic set "bset" is a superset of the basic set described
  * by "tab", i.e., check whether all constraints of "bset" are redundant.
+ * "facet" is a basic set representation of the same set as "tab".
+ * Constraints of "bset" that also appear in "facet" are known
+ * to be redundant without having to check them in "tab".
  */
 static isl_bool bset_covers_tab(__isl_keep isl_basic_set *bset,
-	struct isl_tab *tab)
+	__isl_keep isl_basic_set *facet, struct isl_tab *tab)
 {
 	int i;
 
-	if (!bset || !tab)
+	if (!bset || !facet || !tab)
 		return isl_bool_error;
 
 	for (i = 0; i < bset->n_ineq; ++i) {
-		enum isl_ineq_type type = isl_tab_ineq_type(tab, bset->ineq[i]);
+		enum isl_ineq_type type;
+
+		if (bset_plain_has_ineq(facet, bset->ineq[i]))
+			continue;
+		type = isl_tab_ineq_type(tab, bset->ineq[i]);
 		switch (type) {
 		case isl_ineq_error:		return isl_bool_error;
 		case isl_ineq_redundant:	continue;
@@ -850,6 +879,10 @@ static int update_todo(struct isl_facet_todo *first, struct isl_tab *tab)
  * that contain the facet and have a full-dimensional intersection with
  * the other side of the facet.  For each of the interior facets, we
  * again create todo items, taking care to cancel opposite todo items.
+ * Since an activity domain that contains the facet necessarily
+ * contains any point of the facet, we first check whether
+ * the activity domain contains the sample point of the facet
+ * before performing the more expensive check on the entire facet.
  */
 static __isl_give isl_vertices *compute_chambers(__isl_take isl_basic_set *bset,
 	__isl_take isl_vertices *vertices)
@@ -918,9 +951,20 @@ static __isl_give isl_vertices *compute_chambers(__isl_take isl_basic_set *bset,
 		if (isl_tab_freeze_constraint(tab, tab->n_con - 1) < 0)
 			goto error;
 
+		isl_vec_free(sample);
+		sample = isl_tab_get_sample_value(todo->tab);
+		if (!sample)
+			goto error;
+
 		for (i = 0; i < vertices->n_vertices; ++i) {
+			selection[i] = isl_basic_set_contains(
+					    vertices->v[i].dom, sample);
+			if (selection[i] < 0)
+				goto error;
+			if (!selection[i])
+				continue;
 			selection[i] = bset_covers_tab(vertices->v[i].dom,
-							todo->tab);
+						todo->bset, todo->tab);
 			if (selection[i] < 0)
 				goto error;
 			if (!selection[i])